@@ -0,0 +1,57 @@
+# include guard
+include_guard(DIRECTORY)
+
+##########################################################################################
+#
+#        Records the compile time and code size of the submodule libraries
+#
+##########################################################################################
+
+option(USE_COMPILE_REPORT "Record compile time and code size of the submodule sources" ON)
+
+# directory the compiler launcher writes to -- @ONLY variable
+set(INST_COMPILE_REPORT_DIR ${CMAKE_BINARY_DIR}/compile-report)
+
+#----------------------------------------------------------------------------------------#
+# wrap the compilation of the sources of a submodule library with the launcher
+#
+function(ADD_COMPILE_REPORT _TARGET _MODULE)
+    if(NOT USE_COMPILE_REPORT)
+        return()
+    endif()
+
+    foreach(_LANG C CXX)
+        set(_LAUNCHER ${PYTHON_EXECUTABLE}
+            ${PROJECT_SOURCE_DIR}/cmake/Scripts/compile-launcher.py
+            ${INST_COMPILE_REPORT_DIR}/${_MODULE})
+        # chain any user-provided launcher, e.g. ccache
+        if(CMAKE_${_LANG}_COMPILER_LAUNCHER)
+            list(APPEND _LAUNCHER ${CMAKE_${_LANG}_COMPILER_LAUNCHER})
+        endif()
+        set_target_properties(${_TARGET} PROPERTIES ${_LANG}_COMPILER_LAUNCHER "${_LAUNCHER}")
+    endforeach()
+
+    set_property(GLOBAL APPEND PROPERTY INST_COMPILE_REPORT_TARGETS ${_TARGET})
+endfunction()
+
+#----------------------------------------------------------------------------------------#
+# 'compile-report' target generating compile-report.txt after the submodule libraries
+#
+function(ADD_COMPILE_REPORT_TARGET)
+    if(NOT USE_COMPILE_REPORT)
+        return()
+    endif()
+
+    get_property(_TARGETS GLOBAL PROPERTY INST_COMPILE_REPORT_TARGETS)
+
+    add_custom_target(compile-report ALL
+        COMMAND ${PYTHON_EXECUTABLE}
+            ${CMAKE_BINARY_DIR}/instrument_benchmark/compile_report.py
+            -o ${CMAKE_BINARY_DIR}/compile-report.txt
+        WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+        COMMENT "Generating compile-time and code-size report...")
+
+    if(_TARGETS)
+        add_dependencies(compile-report ${_TARGETS})
+    endif()
+endfunction()
@@ -113,15 +113,17 @@ FUNCTION(DEFINE_SUBMODULE)
     # parse args
     cmake_parse_arguments(
         MODULE
-        "REFERENCE"
+        "REFERENCE;INSTRUMENT_FUNCTIONS"
         "NAME;HEADER_FILE;INTERFACE_LIBRARY;LANGUAGE;LINKER_LANGUAGE"
-        "EXTRA_LANGUAGES"
+        "EXTRA_LANGUAGES;EXCLUDE_FILES;EXCLUDE_FUNCTIONS;VARIANTS;COMPONENTS"
         ${ARGN})
 
     # check required variables
     check_req_var(NAME)
-    check_req_var(HEADER_FILE)
-    check_req_var(INTERFACE_LIBRARY)
+    if(NOT MODULE_COMPONENTS)
+        check_req_var(HEADER_FILE)
+        check_req_var(INTERFACE_LIBRARY)
+    endif()
     check_req_var(LANGUAGE)
 
     # ensure no dashes in module name
@@ -132,9 +134,30 @@ FUNCTION(DEFINE_SUBMODULE)
         set(MODULE_LINKER_LANGUAGE ${MODULE_LANGUAGE})
     endif()
 
+    # a composite of previously defined submodules: the header is generated from the
+    # headers of the components (see cmake/Scripts/composite-header.py) in the binary
+    # directory and the interface libraries of the components are added
+    set(_COMPONENT_HEADERS)
+    if(MODULE_COMPONENTS)
+        get_property(_MODULE_NAMES GLOBAL PROPERTY INST_MODULE_NAMES)
+        foreach(_COMPONENT ${MODULE_COMPONENTS})
+            if(NOT "${_COMPONENT}" IN_LIST _MODULE_NAMES)
+                message(FATAL_ERROR "Component '${_COMPONENT}' of ${MODULE_NAME} is not a submodule defined before it")
+            endif()
+            get_cache_var(_COMPONENT_HEADER    ${_COMPONENT} HEADER_FILE)
+            get_cache_var(_COMPONENT_INTERFACE ${_COMPONENT} INTERFACE_LIBRARY)
+            list(APPEND _COMPONENT_HEADERS ${PROJECT_SOURCE_DIR}/include/${_COMPONENT_HEADER})
+            list(APPEND MODULE_INTERFACE_LIBRARY ${_COMPONENT_INTERFACE})
+        endforeach()
+        list(REMOVE_DUPLICATES MODULE_INTERFACE_LIBRARY)
+        set(MODULE_HEADER_FILE composite/${MODULE_NAME}_inst.h)
+    endif()
+
     # check header language
     set(_HEADER)
-    if(NOT MODULE_REFERENCE)
+    if(MODULE_COMPONENTS)
+        set(_HEADER ${MODULE_HEADER_FILE})
+    elseif(NOT MODULE_REFERENCE)
         if(EXISTS ${PROJECT_SOURCE_DIR}/include/user/${MODULE_HEADER_FILE})
             set(_HEADER user/${MODULE_HEADER_FILE})
         elseif(EXISTS ${MODULE_HEADER_FILE})
@@ -148,15 +171,17 @@ FUNCTION(DEFINE_SUBMODULE)
         set(_HEADER ${MODULE_HEADER_FILE})
     endif()
 
-    if(NOT EXISTS "${PROJECT_SOURCE_DIR}/include/${_HEADER}" OR "${_HEADER}" STREQUAL ""
-       OR IS_DIRECTORY "${PROJECT_SOURCE_DIR}/include/${_HEADER}")
+    if(NOT MODULE_COMPONENTS AND (NOT EXISTS "${PROJECT_SOURCE_DIR}/include/${_HEADER}"
+       OR "${_HEADER}" STREQUAL "" OR IS_DIRECTORY "${PROJECT_SOURCE_DIR}/include/${_HEADER}"))
         message(FATAL_ERROR "Error locating header file: \"${MODULE_HEADER_FILE}\"")
     endif()
 
     # check interface library exists
-    if(NOT TARGET ${MODULE_INTERFACE_LIBRARY})
-        message(FATAL_ERROR "Interface library '${MODULE_INTERFACE_LIBRARY}' does not exist!")
-    endif()
+    foreach(_INTERFACE ${MODULE_INTERFACE_LIBRARY})
+        if(NOT TARGET ${_INTERFACE})
+            message(FATAL_ERROR "Interface library '${_INTERFACE}' does not exist!")
+        endif()
+    endforeach()
 
     set(_VALID_LANGUAGES C CXX CUDA Fortran)
 
@@ -170,17 +195,67 @@ FUNCTION(DEFINE_SUBMODULE)
         message(FATAL_ERROR "LINKER_LANGUAGE '${MODULE_LINKER_LANGUAGE}' is not one of: ${_VALID_LANGUAGES}")
     endif()
 
+    # the compiler-inserted (-finstrument-functions) variant is an additional submodule
+    set(_NAMES ${MODULE_NAME})
+    if(MODULE_INSTRUMENT_FUNCTIONS AND USE_INSTRUMENT_FUNCTIONS)
+        list(APPEND _NAMES ${MODULE_NAME}_cyg)
+    endif()
+
+    # each build variant is an additional submodule named after the variant, e.g.
+    # "O0", "lto", "static", "tls-initial-exec" or combinations such as "O2+lto"
+    set(_VARIANTS ${MODULE_VARIANTS} ${INSTRUMENT_BUILD_VARIANTS})
+    if(_VARIANTS)
+        list(REMOVE_DUPLICATES _VARIANTS)
+    endif()
+    foreach(_VARIANT ${_VARIANTS})
+        string(REPLACE "+" ";" _FLAGS "${_VARIANT}")
+        set(_SKIP OFF)
+        foreach(_FLAG ${_FLAGS})
+            if(NOT "${_FLAG}" IN_LIST INSTRUMENT_VALID_VARIANTS)
+                message(FATAL_ERROR "Build variant '${_FLAG}' of ${MODULE_NAME} is not one of: ${INSTRUMENT_VALID_VARIANTS}")
+            endif()
+            if("${_FLAG}" STREQUAL "lto")
+                if(NOT DEFINED INSTRUMENT_IPO_SUPPORTED)
+                    include(CheckIPOSupported)
+                    check_ipo_supported(RESULT _IPO LANGUAGES C CXX)
+                    set(INSTRUMENT_IPO_SUPPORTED ${_IPO} CACHE INTERNAL "LTO is supported")
+                endif()
+                if(NOT INSTRUMENT_IPO_SUPPORTED)
+                    message(WARNING "LTO is not supported, skipping build variant '${_VARIANT}' of ${MODULE_NAME}")
+                    set(_SKIP ON)
+                endif()
+            endif()
+        endforeach()
+        if(NOT _SKIP)
+            string(REGEX REPLACE "[^A-Za-z0-9]" "_" _TAG "${_VARIANT}")
+            list(APPEND _NAMES ${MODULE_NAME}_${_TAG})
+            set(_VARIANT_${MODULE_NAME}_${_TAG} "${_VARIANT}")
+        endif()
+    endforeach()
+
     # assemble cache variables
-    set(_NAME ${MODULE_NAME})
-    set_property(GLOBAL APPEND PROPERTY INST_MODULE_NAMES "${MODULE_NAME}")
-    set_cache_var(${_NAME} HEADER_FILE       "${_HEADER}"                   "Header file for ${_NAME}")
-    set_cache_var(${_NAME} INTERFACE_LIBRARY "${MODULE_INTERFACE_LIBRARY}"  "Interface library for ${_NAME}")
-    set_cache_var(${_NAME} LANGUAGE          "${MODULE_LANGUAGE}"           "Language for ${_NAME}")
-    set_cache_var(${_NAME} LINKER_LANGUAGE   "${MODULE_LINKER_LANGUAGE}"    "Linker Language for ${_NAME}")
-    set_cache_var(${_NAME} IS_REFERENCE      "${MODULE_REFERENCE}"          "${_NAME} is reference target")
-
-    foreach(_EXTRA ${MODULE_EXTRA_LANGUAGES})
-        set_cache_var(${_NAME} EXTRA_LANGUAGES "${_EXTRA}" "Additional languages in ${_NAME}")
+    foreach(_NAME ${_NAMES})
+        set(_CYG OFF)
+        if("${_NAME}" STREQUAL "${MODULE_NAME}_cyg")
+            set(_CYG ON)
+        endif()
+
+        set_property(GLOBAL APPEND PROPERTY INST_MODULE_NAMES "${_NAME}")
+        set_cache_var(${_NAME} HEADER_FILE       "${_HEADER}"                   "Header file for ${_NAME}")
+        set_cache_var(${_NAME} INTERFACE_LIBRARY "${MODULE_INTERFACE_LIBRARY}"  "Interface library for ${_NAME}")
+        set_cache_var(${_NAME} LANGUAGE          "${MODULE_LANGUAGE}"           "Language for ${_NAME}")
+        set_cache_var(${_NAME} LINKER_LANGUAGE   "${MODULE_LINKER_LANGUAGE}"    "Linker Language for ${_NAME}")
+        set_cache_var(${_NAME} IS_REFERENCE      "${MODULE_REFERENCE}"          "${_NAME} is reference target")
+        set_cache_var(${_NAME} INSTRUMENT_FUNCTIONS "${_CYG}"                   "${_NAME} is built with -finstrument-functions")
+        set_cache_var(${_NAME} EXCLUDE_FILES     "${MODULE_EXCLUDE_FILES}"      "Files excluded from -finstrument-functions in ${_NAME}")
+        set_cache_var(${_NAME} EXCLUDE_FUNCTIONS "${MODULE_EXCLUDE_FUNCTIONS}"  "Functions excluded from -finstrument-functions in ${_NAME}")
+        set_cache_var(${_NAME} VARIANT           "${_VARIANT_${_NAME}}"         "Build variant of ${_NAME}")
+        set_cache_var(${_NAME} COMPONENTS        "${MODULE_COMPONENTS}"         "Components of the composite ${_NAME}")
+        set_cache_var(${_NAME} COMPONENT_HEADERS "${_COMPONENT_HEADERS}"        "Component headers of the composite ${_NAME}")
+
+        foreach(_EXTRA ${MODULE_EXTRA_LANGUAGES})
+            set_cache_var(${_NAME} EXTRA_LANGUAGES "${_EXTRA}" "Additional languages in ${_NAME}")
+        endforeach()
     endforeach()
 
 ENDFUNCTION()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python
+
+# MIT License
+#
+# Copyright (c) 2019 The Regents of the University of California
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""
+Compiler launcher used by the submodule libraries to record the compile time and the
+code size of every object file:
+
+    compile-launcher.py <output-directory> <compiler> <arguments...>
+
+The result is written to <output-directory>/<object-name>.json
+"""
+
+from __future__ import absolute_import
+from __future__ import print_function
+import os
+import sys
+import json
+import time
+import struct
+import subprocess
+
+# section types and symbol types in the ELF specification
+SHT_SYMTAB = 2
+STT_OBJECT = 1
+STT_FUNC = 2
+
+
+def elf_sizes(path):
+    """Returns the size of the .text sections and the number of defined function and
+    object symbols of an ELF relocatable object (empty if not ELF)"""
+    with open(path, "rb") as f:
+        data = bytearray(f.read())
+
+    if data[:4] != bytearray(b"\x7fELF"):
+        return {}
+
+    is64 = data[4] == 2
+    endian = "<" if data[5] == 1 else ">"
+
+    if is64:
+        shoff = struct.unpack_from(endian + "Q", data, 0x28)[0]
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", data, 0x3A)
+        shfmt = endian + "IIQQQQIIQQ"
+    else:
+        shoff = struct.unpack_from(endian + "I", data, 0x20)[0]
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", data, 0x2E)
+        shfmt = endian + "IIIIIIIIII"
+
+    # (name, type, offset, size, entsize)
+    sections = []
+    for i in range(shnum):
+        sh = struct.unpack_from(shfmt, data, shoff + i * shentsize)
+        sections.append((sh[0], sh[1], sh[4], sh[5], sh[9]))
+
+    def section_name(index):
+        strtab = sections[shstrndx][2]
+        beg = strtab + index
+        end = data.index(0, beg)
+        return data[beg:end].decode("utf-8", "replace")
+
+    text = 0
+    symbols = 0
+    for name, stype, offset, size, entsize in sections:
+        sname = section_name(name)
+        if sname == ".text" or sname.startswith(".text."):
+            text += size
+        if stype == SHT_SYMTAB and entsize > 0:
+            for i in range(size // entsize):
+                beg = offset + i * entsize
+                if is64:
+                    info, _, shndx = struct.unpack_from(endian + "BBH", data, beg + 4)
+                else:
+                    info, _, shndx = struct.unpack_from(endian + "BBH", data, beg + 12)
+                if shndx != 0 and (info & 0xf) in (STT_FUNC, STT_OBJECT):
+                    symbols += 1
+
+    return {"text_size": text, "symbols": symbols}
+
+
+def argument(args, flag):
+    """Value following 'flag' in the compiler arguments"""
+    for i in range(len(args) - 1):
+        if args[i] == flag:
+            return args[i + 1]
+    return None
+
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 3:
+        print("usage: {} <output-directory> <compiler> <arguments...>".format(
+            sys.argv[0]))
+        sys.exit(1)
+
+    output_dir = sys.argv[1]
+    command = sys.argv[2:]
+
+    beg = time.time()
+    ret = subprocess.call(command)
+    end = time.time()
+
+    obj = argument(command, "-o")
+    src = argument(command, "-c")
+    if ret != 0 or obj is None or src is None or not os.path.exists(obj):
+        sys.exit(ret)
+
+    entry = {"source": src,
+             "object": obj,
+             "compile_time": end - beg,
+             "object_size": os.path.getsize(obj)}
+    try:
+        entry.update(elf_sizes(obj))
+    except Exception as e:
+        print("compile-launcher: unable to read '{}': {}".format(obj, e))
+
+    if not os.path.exists(output_dir):
+        try:
+            os.makedirs(output_dir)
+        except OSError:
+            pass  # created by a concurrent compile
+
+    fname = os.path.join(output_dir, "{}.json".format(os.path.basename(obj)))
+    with open(fname, "w") as f:
+        json.dump(entry, f)
+
+    sys.exit(ret)
@@ -0,0 +1,185 @@
+#!/usr/bin/env python
+
+# MIT License
+#
+# Copyright (c) 2019 The Regents of the University of California
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""
+Generates the header of a composite submodule from the ordered headers of its
+components:
+
+    composite-header.py <output-header> <component-header> [<component-header>...]
+
+The INSTRUMENT_* macros of the i-th component are renamed to INSTRUMENT_<i>_* and the
+local variables declared by them (e.g. "void* timer = ...") are suffixed with _inst<i>
+so the components can be expanded in the same scope. The INSTRUMENT_* macros of the
+composite expand to the components in order (configure, create, start, enter) or in
+reverse order (stop, exit, suspend, finalize) so the regions of the tools nest, and the
+same holds for the variants with a label. A component without a label variant falls
+back to the macro without a label.
+"""
+
+from __future__ import absolute_import
+from __future__ import print_function
+import os
+import re
+import sys
+
+# macros of the instrumentation API and whether the components are expanded in order
+MACROS = [("CONFIGURE", True), ("CREATE", True), ("START", True), ("ENTER", True),
+          ("CREATE_LABEL", True), ("START_LABEL", True), ("STOP", False),
+          ("STOP_LABEL", False), ("EXIT", False), ("SUSPEND", False), ("FINALIZE", False)]
+
+# macros without parameters
+NO_ARGS = ["CONFIGURE", "SUSPEND", "FINALIZE", "QUERY_DEPTH"]
+
+# names of the macros which are renamed
+API = ("CONFIGURE|CREATE_LABEL|START_LABEL|STOP_LABEL|CREATE|START|STOP|ENTER|EXIT|"
+       "SUSPEND|FINALIZE|QUERY_DEPTH")
+
+# "<type> <name> =", "<type>* <name>;", ... at the beginning of a statement
+DECLARATION = re.compile(r"(?:^|[;{}])\s*(?:const\s+)?[A-Za-z_][\w:]*(?:\s*<[^;{}]*>)?"
+                         r"[\s\*&]+([A-Za-z_]\w*)\s*(?:=|;|\(|\{)")
+
+KEYWORDS = ["return", "else", "case", "goto", "delete", "throw", "typedef", "using",
+            "new", "sizeof", "do"]
+
+
+def logical_lines(text):
+    """Joins the lines continued with a backslash"""
+    return re.sub(r"\\\s*\n", " ", text).split("\n")
+
+
+def rename(text, index, path):
+    """Renames the API macros and the local variables declared by them in the text of
+    the index-th component and makes the relative includes absolute"""
+    macro = re.compile(r"\bINSTRUMENT_({})\b".format(API))
+    text = macro.sub(r"INSTRUMENT_{}_\1".format(index), text)
+
+    # the composite is generated in another directory
+    def _include(match):
+        _path = os.path.join(os.path.dirname(path), match.group(1))
+        if os.path.exists(_path):
+            return '#include "{}"'.format(os.path.realpath(_path))
+        return match.group(0)
+
+    text = re.sub(r'#\s*include\s+"([^"]+)"', _include, text)
+    text = re.sub(r"^\s*#\s*pragma\s+once\s*$", "", text, flags=re.MULTILINE)
+
+    # local variables declared in the bodies of the API macros
+    define = re.compile(r"^\s*#\s*define\s+INSTRUMENT_{}_(?:{})\b(\([^)]*\))?(.*)$"
+                        .format(index, API))
+    local = set()
+    for line in logical_lines(text):
+        match = define.match(line)
+        if match:
+            for name in DECLARATION.findall(match.group(2)):
+                if name not in KEYWORDS:
+                    local.add(name)
+
+    if len(local) == 0:
+        return text, local
+
+    # rename the local variables in the bodies of the API macros only
+    identifier = re.compile(r"\b({})\b".format("|".join(sorted(local))))
+    lines = text.split("\n")
+    in_macro = False
+    for i, line in enumerate(lines):
+        if define.match(line):
+            in_macro = True
+        if in_macro:
+            lines[i] = identifier.sub(r"\1_inst{}".format(index), line)
+            in_macro = line.rstrip().endswith("\\")
+    return "\n".join(lines), local
+
+
+def generate(output, headers):
+    """Writes the composite header"""
+    components = []
+    for i, path in enumerate(headers):
+        with open(path, "r") as f:
+            text, local = rename(f.read(), i + 1, path)
+        components.append((path, text, local))
+
+    out = ["// generated by composite-header.py -- do not edit", "",
+           "#pragma once", ""]
+
+    for i, (path, text, local) in enumerate(components):
+        index = i + 1
+        out += ["//" + "=" * 86 + "//",
+                "// component {}: {}".format(index, path)]
+        if len(local) > 0:
+            out += ["// renamed local variables: {}".format(", ".join(sorted(local)))]
+        out += ["//" + "=" * 86 + "//", "", text.strip(), ""]
+        # components which do not define a macro (the label macros fall back to the
+        # macros without a label, as in fallback_inst.h)
+        for name, _ in MACROS:
+            _macro = "INSTRUMENT_{}_{}".format(index, name)
+            if name.endswith("_LABEL"):
+                _body = "(label) INSTRUMENT_{}_{}(label)".format(index, name[:-6])
+            else:
+                _body = "()" if name in NO_ARGS else "(...)"
+            out += ["#if !defined({})".format(_macro),
+                    "#    define {}{}".format(_macro, _body), "#endif"]
+        out += [""]
+
+    out += ["//" + "=" * 86 + "//", "// composite", "//" + "=" * 86 + "//", ""]
+
+    count = len(components)
+    for name, forward in MACROS:
+        order = range(1, count + 1) if forward else range(count, 0, -1)
+        if name in NO_ARGS:
+            body = " ".join(["INSTRUMENT_{}_{}()".format(i, name) for i in order])
+            out += ["#define INSTRUMENT_{}() {}".format(name, body)]
+        else:
+            body = " ".join(["INSTRUMENT_{}_{}(__VA_ARGS__)".format(i, name)
+                             for i in order])
+            out += ["#define INSTRUMENT_{}(...) {}".format(name, body)]
+
+    # region depth of the first component which tracks it
+    for i in range(1, count + 1):
+        _macro = "INSTRUMENT_{}_QUERY_DEPTH".format(i)
+        out += ["", "#if !defined(INSTRUMENT_QUERY_DEPTH) && defined({})".format(_macro),
+                "#    define INSTRUMENT_QUERY_DEPTH() {}()".format(_macro), "#endif"]
+
+    content = "\n".join(out) + "\n"
+
+    # do not touch the header (and rebuild) if nothing changed
+    if os.path.exists(output):
+        with open(output, "r") as f:
+            if f.read() == content:
+                return
+
+    if not os.path.exists(os.path.dirname(output)):
+        os.makedirs(os.path.dirname(output))
+    with open(output, "w") as f:
+        f.write(content)
+
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 3:
+        print("usage: {} <output-header> <component-header> [<component-header>...]"
+              .format(sys.argv[0]))
+        sys.exit(1)
+
+    generate(sys.argv[1], sys.argv[2:])
@@ -1,6 +1,7 @@
 #!/usr/bin/env python
 
 import os
+import re
 import argparse
 import instrument_benchmark as bench
 from statistics import mean, stdev
@@ -101,6 +102,70 @@ def print_info(results, label, chunk_size=5, baseline=None):
             "overhead": [mean(_fover), stdev(_fover)]}
 
 
+def print_floor(label, overhead, floor):
+    """Prints the mean overhead of each submodule as a multiple of the floor submodule"""
+    if floor is None or floor not in overhead or overhead[floor] <= 0.0:
+        return
+    lprint("\n{} (overhead / {}):\n".format(label, floor))
+    for key, value in overhead.items():
+        lprint("\t{:20} : {:10.3f}".format(key, value / overhead[floor]))
+    lprint("")
+
+
+def print_cyg(label, overhead):
+    """Prints the mean overhead of the -finstrument-functions variant (<name>_cyg) of each
+    submodule next to the overhead of its manual markers"""
+    pairs = [(key[:-len("_cyg")], key) for key in overhead
+             if key.endswith("_cyg") and key[:-len("_cyg")] in overhead]
+    if len(pairs) == 0:
+        return
+    lprint("\n{} (manual markers vs. -finstrument-functions):\n".format(label))
+    for manual, cyg in pairs:
+        lprint("\t{:20} : {:10.3e} (manual) {:10.3e} (cyg)".format(
+            manual, overhead[manual], overhead[cyg]))
+    lprint("")
+
+
+def print_variants(label, overhead, baseline):
+    """Prints the mean overhead of the build variants (<name>_<variant>) of each
+    submodule next to the default build, and less the overhead of the same variant of
+    the baseline submodule (if built) which is the code-generation effect on the test"""
+    entries = []
+    for key, variant in sorted(bench.variants.items()):
+        base = key[:-len(re.sub("[^A-Za-z0-9]", "_", variant)) - 1]
+        if key in overhead and base in overhead and base != baseline:
+            entries.append((base, variant, key))
+    if len(entries) == 0:
+        return
+    lprint("\n{} (build variants):\n".format(label))
+    for base, variant, key in entries:
+        ref = overhead.get(baseline + key[len(base):], 0.0)
+        lprint("\t{:20} : {:10.3e} (default) {:10.3e} ({}) {:10.3e} (net)".format(
+            base, overhead[base], overhead[key], variant, overhead[key] - ref))
+    lprint("")
+
+
+def print_composites(label, overhead):
+    """Prints the overhead of each composite submodule (several tools stacked) next to
+    the sum of the overheads of its components measured individually. A difference is
+    the interference of the tools (e.g. competing TLS or signal handlers)"""
+    entries = []
+    for key, components in sorted(bench.composites.items()):
+        if key in overhead and all([c in overhead for c in components]):
+            entries.append((key, components))
+    if len(entries) == 0:
+        return
+    lprint("\n{} (composites):\n".format(label))
+    for key, components in entries:
+        total = sum([overhead[c] for c in components])
+        ratio = overhead[key] / total if total > 0.0 else 0.0
+        lprint("\t{:20} : {:10.3e} (composite) {:10.3e} (sum) {:10.3e} (interference) "
+               "{:8.3f} (ratio) [{}]".format(key, overhead[key], total,
+                                            overhead[key] - total, ratio,
+                                            " + ".join(components)))
+    lprint("")
+
+
 if __name__ == "__main__":
 
     submodules = sorted(bench.submodules)
@@ -108,17 +173,26 @@ if __name__ == "__main__":
         raise RuntimeError("No submodules!")
 
     default_baseline = "baseline" if "baseline" in submodules else submodules[0]
+    default_floor = "tsc_ring" if "tsc_ring" in submodules else None
 
     parser = argparse.ArgumentParser()
 
     parser.add_argument("-p", "--prefix", type=str, default="DISABLED")
     parser.add_argument("-m", "--modes", type=str, nargs='*',
-                        default=["fibonacci", "matrix"], choices=["fibonacci", "matrix"])
+                        default=["fibonacci", "matrix"],
+                        choices=["fibonacci", "matrix", "model", "scaling",
+                                 "lifecycle", "startup", "compile", "tree",
+                                 "replay", "drift", "interpose", "coroutine",
+                                 "churn", "unwind", "boundary", "cold",
+                                 "contention", "syscall", "chase"])
     parser.add_argument("-l", "--languages", type=str, choices=["c", "cxx"],
                         default=["c", "cxx"], nargs='*')
     parser.add_argument("-b", "--baseline", type=str, choices=submodules,
                         default=default_baseline, required=False,
                         help="Compute overhead w.r.t. to this submodule measurement")
+    parser.add_argument("-F", "--floor", type=str, choices=submodules,
+                        default=default_floor, required=False,
+                        help="Report overhead as a multiple of this submodule")
     parser.add_argument("-i", "--iterations", type=int, default=50,
                         help="Number of iterations per timing entry")
     # specific to MATMUL
@@ -131,6 +205,96 @@ if __name__ == "__main__":
                         default=43, help="Fibonacci value")
     parser.add_argument("-c", "--cutoff", type=int,
                         default=23, help="Fibonacci cutoff")
+    # specific to MODEL
+    parser.add_argument("-d", "--densities", type=int, nargs='*',
+                        default=[19, 21, 23, 25, 27],
+                        help="Fibonacci cutoffs used to fit the overhead model")
+    # specific to SCALING
+    parser.add_argument("-N", "--nprocs", type=int, nargs='*', default=[1, 2, 4],
+                        help="Number of worker processes for node-level scaling")
+    # specific to LIFECYCLE
+    parser.add_argument("-r", "--regions", type=int, nargs='*',
+                        default=[1, 10, 100, 1000, 10000],
+                        help="Number of recorded regions before finalization")
+    parser.add_argument("-o", "--output-dir", type=str, default="",
+                        help="Output directory of the tool (measures bytes written)")
+
+    # specific to TREE
+    parser.add_argument("-D", "--depths", type=int, nargs='*',
+                        default=[1, 10, 100, 1000], help="Depths of the region tree")
+    parser.add_argument("-k", "--fanout", type=int, default=2,
+                        help="Regions per level of the region tree")
+    parser.add_argument("-w", "--work", type=int, default=100,
+                        help="Leaf work (iterations) of the region tree")
+
+    # specific to REPLAY
+    parser.add_argument("-t", "--traces", type=str, nargs='*', default=[],
+                        help="Region traces (binary or CSV) to replay")
+
+    # specific to INTERPOSE
+    parser.add_argument("-S", "--symbols", type=int, nargs='*', default=[1, 4, 16, 64],
+                        help="Number of wrapped library functions")
+    parser.add_argument("--calls", type=int, default=1000000,
+                        help="Library calls per timing entry")
+    parser.add_argument("--call-work", type=int, default=0,
+                        help="Work (iterations) per library call")
+
+    # specific to CHURN
+    parser.add_argument("-T", "--threads", type=int, default=1000,
+                        help="Number of short-lived threads per timing entry")
+    parser.add_argument("-R", "--thread-regions", type=int, nargs='*', default=[1, 4, 16],
+                        help="Regions per short-lived thread")
+
+    # specific to UNWIND
+    parser.add_argument("--throw-rates", type=float, nargs='*',
+                        default=[0.001, 0.01, 0.1],
+                        help="Probability of a fibonacci leaf throwing")
+    parser.add_argument("--unwind-levels", type=int, default=2,
+                        help="Region levels an exception unwinds through")
+
+    # specific to COLD
+    parser.add_argument("--labels", type=int, default=1000,
+                        help="Number of new labels per timing entry")
+    parser.add_argument("--cold-calls", type=int, default=2,
+                        help="First invocations of each label timed as cold")
+    parser.add_argument("--warm-calls", type=int, default=8,
+                        help="Further (steady-state) invocations of each label")
+    parser.add_argument("--flush-bytes", type=int, nargs='*', default=[0, 32 << 20],
+                        help="Bytes written/read before each cold invocation (0 = none)")
+
+    # specific to CONTENTION
+    parser.add_argument("--contention-threads", type=int, nargs='*', default=[1, 2, 4, 8],
+                        help="Number of threads entering the regions at once")
+    parser.add_argument("--overlap", type=float, default=0.25,
+                        help="Fraction of the regions using the shared label when mixed")
+    parser.add_argument("--contention-regions", type=int, default=100000,
+                        help="Regions per thread per timing entry")
+
+    # specific to SYSCALL
+    parser.add_argument("--io-ops", type=int, default=10000,
+                        help="Writes and reads per timing entry")
+    parser.add_argument("--io-bytes", type=int, nargs='*', default=[64, 512, 4096],
+                        help="Bytes per write and read")
+    parser.add_argument("--fsync-every", type=int, default=0,
+                        help="fsync after every n-th write (0 = never)")
+    parser.add_argument("--io-directory", type=str, default="",
+                        help="Directory of the temporary file (default: tmpfs)")
+
+    # specific to CHASE
+    parser.add_argument("--nodes", type=int, default=65536,
+                        help="Nodes of the randomized linked structure")
+    parser.add_argument("--steps", type=int, default=1000000,
+                        help="Nodes visited per timing entry")
+    parser.add_argument("--node-densities", type=float, nargs='*',
+                        default=[0.01, 0.1, 1.0], help="Fraction of the nodes instrumented")
+
+    # specific to COROUTINE
+    parser.add_argument("--tasks", type=int, default=1000,
+                        help="Number of pipelined coroutines")
+    parser.add_argument("--stages", type=int, default=4,
+                        help="Regions (suspension points) per coroutine")
+    parser.add_argument("--executor-threads", type=int, nargs='*', default=[1, 2, 4],
+                        help="Number of threads resuming the coroutines")
 
     args = parser.parse_args()
 
@@ -154,9 +318,44 @@ if __name__ == "__main__":
     submodules.remove(args.baseline)
     submodules = [args.baseline] + submodules
 
+    # lifecycle entries run in fresh interpreters, before any tool is configured here
+    if "lifecycle" in args.modes:
+        from instrument_benchmark import lifecycle
+        for submodule in submodules:
+            key = "[{}]> {}_{}".format("CXX", "LIFECYCLE", submodule.upper())
+            lprint("Executing {}...".format(key))
+            lifecycle.report(submodule,
+                             lifecycle.measure(submodule, args.regions, args.output_dir),
+                             lprint)
+
+    # isolated trials fork the current process so run them before anything else
+    if "drift" in args.modes:
+        for lang in args.languages:
+            baseline = {}
+            for submodule in submodules:
+                key = "[{}]> {}_{}".format(lang.upper(), "DRIFT", submodule.upper())
+                lprint("Executing {}...".format(key))
+                _mod = getattr(bench, submodule)
+                runs = {"isolated": _mod.fibonacci_isolated(m_F, m_C, m_E, lang),
+                        "in-process": _mod.fibonacci(m_F, m_C, m_E, lang)}
+                lprint("\n{}:\n".format(key))
+                for mode, ret in runs.items():
+                    if ret is None:
+                        continue
+                    if mode not in baseline:
+                        baseline[mode] = ret
+                    _over = ret.overhead(baseline[mode])
+                    _fit = ret.drift(baseline[mode])
+                    lprint("\t{:20} : {:10.3e} (mean) {:10.3e} +/- {:10.3e} (slope) "
+                           "{:8.3f} (relative)".format(
+                               "{} (sec)".format(mode), mean(_over), _fit["slope"],
+                               _fit["slope_err"], _fit["relative"]))
+                lprint("")
+
     if "matrix" in args.modes:
         for lang in args.languages:
             baseline = None
+            overhead = {}
             for submodule in submodules:
                 key = "[{}]> {}_{}".format(
                     lang.upper(), "MATMUL", submodule.upper())
@@ -173,6 +372,11 @@ if __name__ == "__main__":
                     mtx_over_data["y"] += [data["overhead"][0]]
                     mtx_time_data["yerr"] += [data["runtime"][1]]
                     mtx_over_data["yerr"] += [data["overhead"][1]]
+                    overhead[submodule] = data["overhead"][0]
+            print_floor("[{}]> MATMUL".format(lang.upper()), overhead, args.floor)
+            print_cyg("[{}]> MATMUL".format(lang.upper()), overhead)
+            print_variants("[{}]> MATMUL".format(lang.upper()), overhead, args.baseline)
+            print_composites("[{}]> MATMUL".format(lang.upper()), overhead)
 
     if len(mtx_keys) > 0:
         plot(mtx_keys, mtx_time_data["y"],
@@ -187,6 +391,7 @@ if __name__ == "__main__":
     if "fibonacci" in args.modes:
         for lang in args.languages:
             baseline = None
+            overhead = {}
             for submodule in submodules:
                 key = "[{}]> {}_{}".format(
                     lang.upper(), "FIBONACCI", submodule.upper())
@@ -203,6 +408,12 @@ if __name__ == "__main__":
                     fib_over_data["y"] += [data["overhead"][0]]
                     fib_time_data["yerr"] += [data["runtime"][1]]
                     fib_over_data["yerr"] += [data["overhead"][1]]
+                    overhead[submodule] = data["overhead"][0]
+            print_floor("[{}]> FIBONACCI".format(lang.upper()), overhead, args.floor)
+            print_cyg("[{}]> FIBONACCI".format(lang.upper()), overhead)
+            print_variants("[{}]> FIBONACCI".format(lang.upper()), overhead,
+                           args.baseline)
+            print_composites("[{}]> FIBONACCI".format(lang.upper()), overhead)
 
     if len(fib_keys) > 0:
         plot(fib_keys, fib_time_data["y"],
@@ -214,4 +425,296 @@ if __name__ == "__main__":
                  m_F, m_C),
              "{}_FIBONACCI_OVERHEAD.png".format(args.prefix.upper().strip("_")))
 
+    if "model" in args.modes:
+        for submodule in submodules:
+            key = "[{}]> {}_{}".format("CXX", "MODEL", submodule.upper())
+            lprint("Executing {}...".format(key))
+            ret = getattr(bench, submodule).overhead_model(
+                "fibonacci", m_F, args.densities, m_I)
+            lprint("\n{}:\n".format(key))
+            for point in ret["points"]:
+                lprint("\t{:20} : {:>10} calls, {:10.3e} (base) {:10.3e} (inst) sec".format(
+                    "cutoff = {}".format(point["density"]), point["n_calls"],
+                    point["base"], point["timing"]))
+            lprint("")
+            lprint("\t{:20} : {:10.3e} +/- {:10.3e}".format(
+                "c_direct (sec)", ret["c_direct"], ret["c_direct_err"]))
+            lprint("\t{:20} : {:10.3e} +/- {:10.3e}".format(
+                "perturbation (sec)", ret["perturbation"], ret["perturbation_err"]))
+            lprint("\t{:20} : {:10.3f}".format("r^2", ret["r2"]))
+            lprint("")
+
+    if "scaling" in args.modes:
+        for nproc in args.nprocs:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "SCALING", nproc, submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).fibonacci_multiprocess(
+                    nproc, m_F, m_C, m_I)
+                lprint("\n{}:\n".format(key))
+                lprint("\t{:20} : {:10.3e} (min) {:10.3e} (max)".format(
+                    "runtime (sec)", min(ret["runtime"]), max(ret["runtime"])))
+                lprint("\t{:20} : {:10.3e} (min) {:10.3e} (max) {:10.3e} (stdev)".format(
+                    "overhead (sec)", ret["min"], ret["max"], ret["stdev"]))
+                lprint("\t{:20} : {:10.3e}".format("aggregate (sec)", ret["aggregate"]))
+                lprint("\t{:20} : {:10.3e}".format("makespan (sec)", ret["makespan"]))
+                lprint("")
+
+    if "tree" in args.modes:
+        for labels in ["same", "distinct"]:
+            for depth in args.depths:
+                baseline = None
+                for submodule in submodules:
+                    key = "[{}]> {}_{}_{}_{}".format("CXX", "TREE", labels.upper(),
+                                                     depth, submodule.upper())
+                    lprint("Executing {}...".format(key))
+                    ret = getattr(bench, submodule).region_tree(
+                        depth, args.fanout, args.work, labels, m_I)
+                    if baseline is None:
+                        baseline = ret
+                    metrics = ret.metrics()
+                    regions = metrics["regions"]
+                    lprint("\n{}:\n".format(key))
+                    lprint("\t{:20} : {:10}".format("regions", int(regions)))
+                    lprint("\t{:20} : {:10.3e}".format(
+                        "per-call (sec)", mean(ret.overhead(baseline)) / regions))
+                    lprint("\t{:20} : {:10.3e}".format(
+                        "per-call (self, sec)", metrics["overhead_per_call"]))
+                    lprint("\t{:20} : {:10}".format(
+                        "memory (bytes)", int(metrics["rss_delta"])))
+                    lprint("")
+
+    if "replay" in args.modes:
+        for trace in args.traces:
+            baseline = None
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "REPLAY", os.path.basename(trace),
+                                              submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).trace_replay(trace, m_I)
+                if baseline is None:
+                    baseline = ret
+                metrics = ret.metrics()
+                data = print_info(ret, key, baseline=baseline)
+                lprint("")
+                lprint("\t{:20} : {:10}".format("regions", int(metrics["regions"])))
+                lprint("\t{:20} : {:10}".format("threads", int(metrics["threads"])))
+                lprint("\t{:20} : {:10}".format("max depth", int(metrics["max_depth"])))
+                lprint("\t{:20} : {:10.3f}".format("slowdown", metrics["slowdown"]))
+                lprint("\t{:20} : {:10.3f}".format(
+                    "slowdown (baseline)",
+                    data["runtime"][0] / mean(baseline.timing())))
+                lprint("")
+
+    if "interpose" in args.modes:
+        for nsymbols in args.symbols:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "INTERPOSE", nsymbols,
+                                              submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).interpose(
+                    nsymbols, args.calls, args.call_work, m_I)
+                metrics = ret.metrics()
+                lprint("\n{}:\n".format(key))
+                lprint("\t{:20} : {:>14} {:>14} {:>14}".format(
+                    "mode", "per-call (sec)", "wrap (sec)", "setup (sec)"))
+                for mode in ["direct", "preload", "got", "got_inst"]:
+                    lprint("\t{:20} : {:14.3e} {:14.3e} {:14.3e}".format(
+                        mode, metrics["per_call_{}".format(mode)],
+                        metrics.get("wrap_{}".format(mode), 0.0),
+                        metrics["setup_{}".format(mode)]))
+                lprint("")
+
+    if "churn" in args.modes:
+        for nregions in args.thread_regions:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "CHURN", nregions, submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).thread_churn(
+                    args.threads, nregions, args.work, m_I)
+                metrics = ret.metrics()
+                lprint("\n{}:\n".format(key))
+                lprint("\t{:20} : {:10}".format("threads", int(metrics["lifetimes"])))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "per-thread (sec)", metrics["overhead_per_thread"]))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "set-up (sec)", metrics["setup_per_thread"]))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "tear-down (sec)", metrics["teardown_per_thread"]))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "per-call (sec)", metrics["overhead_per_call"]))
+                lprint("\t{:20} : {:10}".format(
+                    "memory (bytes)", int(metrics["rss_delta"])))
+                lprint("\t{:20} : {:10.1f}".format(
+                    "memory/thread", metrics["rss_per_thread"]))
+                lprint("")
+
+    if "unwind" in args.modes:
+        for rate in args.throw_rates:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "UNWIND", rate, submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).unwind(
+                    m_F, m_C, rate, args.unwind_levels, m_I)
+                metrics = ret.metrics()
+                lprint("\n{}:\n".format(key))
+                lprint("\t{:20} : {:10}".format("regions", int(metrics["regions"])))
+                lprint("\t{:20} : {:10}".format("throws", int(metrics["throws"])))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "per-call (sec)", metrics["overhead_per_call"]))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "unwind (sec)", metrics["unwind_per_throw"]))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "unwind (inst, sec)", metrics["unwind_per_throw_inst"]))
+                lprint("\t{:20} : {:10}".format(
+                    "depth checks", int(metrics["depth_checked"])))
+                lprint("\t{:20} : {:10}".format(
+                    "depth errors", int(metrics["depth_errors"])))
+                lprint("\t{:20} : {:10}".format(
+                    "leaked regions", int(metrics["leaked_regions"])))
+                lprint("")
+
+    if "cold" in args.modes:
+        for flush_bytes in args.flush_bytes:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "COLD", flush_bytes,
+                                              submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).first_call(
+                    args.labels, args.cold_calls, args.warm_calls, args.work,
+                    flush_bytes, m_I)
+                metrics = ret.metrics()
+                lprint("\n{}:\n".format(key))
+                for k in range(args.cold_calls):
+                    lprint("\t{:20} : {:10.3e}".format(
+                        "call {} (sec)".format(k),
+                        metrics["cold_overhead_{}".format(k)]))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "warm (sec)", metrics["warm_overhead"]))
+                lprint("\t{:20} : {:10.3f}".format(
+                    "cold/warm", metrics["cold_warm_ratio"]))
+                lprint("\t{:20} : {:10.3f}".format(
+                    "cold/warm latency", metrics["cold_warm_latency_ratio"]))
+                lprint("")
+
+    if "contention" in args.modes:
+        for nthreads in args.contention_threads:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "CONTENTION", nthreads,
+                                              submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).contention(
+                    nthreads, args.contention_regions, args.work, args.overlap, m_I)
+                metrics = ret.metrics()
+                lprint("\n{}:\n".format(key))
+                lprint("\t{:20} : {:>14} {:>14}".format(
+                    "labels", "regions/sec", "per-call (sec)"))
+                for pattern in ["shared", "private", "mixed"]:
+                    lprint("\t{:20} : {:14.3e} {:14.3e}".format(
+                        pattern, metrics["throughput_{}".format(pattern)],
+                        metrics["overhead_per_call_{}".format(pattern)]))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "penalty (sec)", metrics["contention_penalty"]))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "mixed penalty (sec)", metrics["mixed_penalty"]))
+                lprint("\t{:20} : {:10.3f}".format(
+                    "shared/private", metrics["contention_ratio"]))
+                lprint("")
+
+    if "syscall" in args.modes:
+        for nbytes in args.io_bytes:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "SYSCALL", nbytes, submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).syscall_io(
+                    args.io_ops, nbytes, args.fsync_every, args.io_directory, m_I)
+                metrics = ret.metrics()
+                lprint("\n{}:\n".format(key))
+                lprint("\t{:20} : {:>14} {:>14}".format(
+                    "operation", "latency (sec)", "per-call (sec)"))
+                for op in ["write", "read", "fsync"]:
+                    if metrics["latency_{}".format(op)] > 0.0:
+                        lprint("\t{:20} : {:14.3e} {:14.3e}".format(
+                            op, metrics["latency_{}".format(op)],
+                            metrics["overhead_{}".format(op)]))
+                lprint("\t{:20} : {:10.3f}".format(
+                    "relative", metrics["overhead_relative"]))
+                lprint("\t{:20} : {:10.1f} (inst) {:10.1f} (base)".format(
+                    "voluntary csw", metrics["voluntary_csw"],
+                    metrics["base_voluntary_csw"]))
+                lprint("\t{:20} : {:10.1f} (inst) {:10.1f} (base)".format(
+                    "involuntary csw", metrics["involuntary_csw"],
+                    metrics["base_involuntary_csw"]))
+                lprint("")
+
+    if "chase" in args.modes:
+        for density in args.node_densities:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "CHASE", density, submodule.upper())
+                lprint("Executing {}...".format(key))
+                ret = getattr(bench, submodule).pointer_chase(
+                    args.nodes, args.steps, density, m_I)
+                metrics = ret.metrics()
+                lprint("\n{}:\n".format(key))
+                lprint("\t{:20} : {:10}".format("regions", int(metrics["regions"])))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "per-call (sec)", metrics["overhead_per_call"]))
+                for counter in ["branch_misses", "itlb_misses", "instructions"]:
+                    name = "{}_per_call".format(counter)
+                    if name in metrics:
+                        lprint("\t{:20} : {:10.3f} (per call) {:10.3f} (base per step)"
+                               .format(counter, metrics[name],
+                                       metrics["base_{}".format(counter)]))
+                    else:
+                        lprint("\t{:20} : {:>10}".format(counter, "n/a"))
+                lprint("")
+
+    if "coroutine" in args.modes:
+        for nthreads in args.executor_threads:
+            for submodule in submodules:
+                key = "[{}]> {}_{}_{}".format("CXX", "COROUTINE", nthreads,
+                                              submodule.upper())
+                ret = getattr(bench, submodule).coroutine(
+                    args.tasks, args.stages, args.work, nthreads, m_I)
+                # not built with USE_COROUTINES
+                if ret is None:
+                    continue
+                lprint("Executing {}...".format(key))
+                metrics = ret.metrics()
+                lprint("\n{}:\n".format(key))
+                lprint("\t{:20} : {:10}".format("regions", int(metrics["regions"])))
+                lprint("\t{:20} : {:10.3e}".format(
+                    "per-call (sec)", metrics["overhead_per_call"]))
+                lprint("\t{:20} : {:10.3f}".format("migrated", metrics["migrated"]))
+                lprint("\t{:20} : {:10.3f}".format("interleaved", metrics["interleaved"]))
+                lprint("\t{:20} : {:10}".format(
+                    "depth checks", int(metrics["depth_checked"])))
+                lprint("\t{:20} : {:10}".format(
+                    "depth errors", int(metrics["depth_errors"])))
+                lprint("")
+
+    if "boundary" in args.modes:
+        from instrument_benchmark import boundary
+        lprint("\n{}:\n".format("[PY]> BOUNDARY"))
+        boundary.report([boundary.measure(submodule, work=args.work, nitr=m_I)
+                         for submodule in submodules], lprint)
+        lprint("")
+
+    if "startup" in args.modes:
+        from instrument_benchmark import startup
+        lprint("\n{}:\n".format("[PY]> STARTUP"))
+        startup.report([startup.measure(submodule) for submodule in submodules], lprint)
+        lprint("")
+
+    if "compile" in args.modes:
+        from instrument_benchmark import compile_report
+        lprint("\n{}:\n".format("[BUILD]> COMPILE"))
+        compile_report.report(compile_report.compare(compile_report.load(), args.baseline),
+                              args.baseline, lprint)
+        lprint("")
+
+    # allow the tools to write their output
+    for submodule in submodules:
+        getattr(bench, submodule).finalize()
+
     lout.close()
@@ -62,4 +62,12 @@ if(ENABLE_CALIPER)
         EXTRA_LANGUAGES     C
     )
 
+    # caliper annotations and the timemory library in the same regions
+    define_submodule(
+        NAME                cali_library
+        LANGUAGE            CXX
+        COMPONENTS          cali_process_scope library
+        EXTRA_LANGUAGES     C
+    )
+
 endif()
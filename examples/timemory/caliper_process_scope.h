@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #if defined(__cplusplus)
+#    include <cstdint>
 #    include <iostream>
 #    include <string>
 #else
@@ -29,9 +30,29 @@
 
 #include <caliper/cali.h>
 
+// regions started and not yet stopped by any thread, since the attribute has process
+// scope (one counter per library)
+__attribute__((weak, visibility("hidden"))) int64_t inst_cali_process_depth = 0;
+
+#define INST_CALI_PROCESS_DEPTH(n)                                                       \
+    __atomic_add_fetch(&inst_cali_process_depth, (n), __ATOMIC_RELAXED);
+
 #define INSTRUMENT_CONFIGURE() cali_init();
 #define INSTRUMENT_CREATE(...)                                                           \
     cali_id_t _id = cali_create_attribute("inst", CALI_TYPE_STRING,                      \
                                           CALI_ATTR_NESTED | CALI_ATTR_SCOPE_PROCESS);
-#define INSTRUMENT_START(...) cali_begin_string(_id, __FUNCTION__);
-#define INSTRUMENT_STOP(...) cali_end(_id);
+#define INSTRUMENT_START(...)                                                            \
+    cali_begin_string(_id, __FUNCTION__);                                                \
+    INST_CALI_PROCESS_DEPTH(1)
+#define INSTRUMENT_STOP(...)                                                             \
+    cali_end(_id);                                                                       \
+    INST_CALI_PROCESS_DEPTH(-1)
+#define INSTRUMENT_CREATE_LABEL(label) INSTRUMENT_CREATE(label)
+#define INSTRUMENT_START_LABEL(label)                                                    \
+    cali_begin_string(_id, (label));                                                     \
+    INST_CALI_PROCESS_DEPTH(1)
+#define INSTRUMENT_STOP_LABEL(label)                                                     \
+    cali_end(_id);                                                                       \
+    INST_CALI_PROCESS_DEPTH(-1)
+#define INSTRUMENT_QUERY_DEPTH()                                                         \
+    __atomic_load_n(&inst_cali_process_depth, __ATOMIC_RELAXED)
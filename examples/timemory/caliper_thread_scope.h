@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #if defined(__cplusplus)
+#    include <cstdint>
 #    include <iostream>
 #    include <string>
 #else
@@ -29,9 +30,24 @@
 
 #include <caliper/cali.h>
 
+// regions started and not yet stopped on the calling thread (one counter per library)
+__attribute__((weak, visibility("hidden"))) __thread int64_t inst_cali_thread_depth = 0;
+
 #define INSTRUMENT_CONFIGURE() cali_init();
 #define INSTRUMENT_CREATE(...)                                                           \
     cali_id_t _id = cali_create_attribute("inst", CALI_TYPE_STRING,                      \
                                           CALI_ATTR_NESTED | CALI_ATTR_SCOPE_THREAD);
-#define INSTRUMENT_START(...) cali_begin_string(_id, __FUNCTION__);
-#define INSTRUMENT_STOP(...) cali_end(_id);
+#define INSTRUMENT_START(...)                                                            \
+    cali_begin_string(_id, __FUNCTION__);                                                \
+    ++inst_cali_thread_depth;
+#define INSTRUMENT_STOP(...)                                                             \
+    cali_end(_id);                                                                       \
+    --inst_cali_thread_depth;
+#define INSTRUMENT_CREATE_LABEL(label) INSTRUMENT_CREATE(label)
+#define INSTRUMENT_START_LABEL(label)                                                    \
+    cali_begin_string(_id, (label));                                                     \
+    ++inst_cali_thread_depth;
+#define INSTRUMENT_STOP_LABEL(label)                                                     \
+    cali_end(_id);                                                                       \
+    --inst_cali_thread_depth;
+#define INSTRUMENT_QUERY_DEPTH() inst_cali_thread_depth
@@ -20,12 +20,27 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 #include <timemory/ctimemory.h>
 
+// markers created and not yet freed on the calling thread (one counter per library)
+__attribute__((weak, visibility("hidden"))) __thread int64_t inst_tim_c_depth = 0;
+
 #define INSTRUMENT_CONFIGURE()
 #define INSTRUMENT_CREATE(...)
-#define INSTRUMENT_START(name) void* timer = TIMEMORY_BASIC_MARKER("", WALL_CLOCK);
-#define INSTRUMENT_STOP(name) FREE_TIMEMORY_MARKER(timer);
+#define INSTRUMENT_START(name)                                                           \
+    void* timer = TIMEMORY_BASIC_MARKER("", WALL_CLOCK);                                 \
+    ++inst_tim_c_depth;
+#define INSTRUMENT_STOP(name)                                                            \
+    FREE_TIMEMORY_MARKER(timer);                                                         \
+    --inst_tim_c_depth;
+#define INSTRUMENT_START_LABEL(label)                                                    \
+    void* timer = TIMEMORY_BASIC_MARKER(label, WALL_CLOCK);                              \
+    ++inst_tim_c_depth;
+#define INSTRUMENT_STOP_LABEL(label)                                                     \
+    FREE_TIMEMORY_MARKER(timer);                                                         \
+    --inst_tim_c_depth;
+#define INSTRUMENT_QUERY_DEPTH() inst_tim_c_depth
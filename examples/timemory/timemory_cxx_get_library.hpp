@@ -28,7 +28,21 @@
 
 #include <timemory/library.h>
 
+// records started and not yet ended on the calling thread (one counter per library)
+__attribute__((weak, visibility("hidden"))) __thread int64_t inst_tim_get_depth = 0;
+
 #define INSTRUMENT_CONFIGURE() timemory_set_default("wall_clock");
 #define INSTRUMENT_CREATE(...)
-#define INSTRUMENT_START(name) uint64_t inst_id = timemory_get_begin_record(__FUNCTION__);
-#define INSTRUMENT_STOP(...) timemory_end_record(inst_id);
+#define INSTRUMENT_START(name)                                                           \
+    uint64_t inst_id = timemory_get_begin_record(__FUNCTION__);                          \
+    ++inst_tim_get_depth;
+#define INSTRUMENT_STOP(...)                                                             \
+    timemory_end_record(inst_id);                                                        \
+    --inst_tim_get_depth;
+#define INSTRUMENT_START_LABEL(label)                                                    \
+    uint64_t inst_id = timemory_get_begin_record(label);                                 \
+    ++inst_tim_get_depth;
+#define INSTRUMENT_STOP_LABEL(label)                                                     \
+    timemory_end_record(inst_id);                                                        \
+    --inst_tim_get_depth;
+#define INSTRUMENT_QUERY_DEPTH() inst_tim_get_depth
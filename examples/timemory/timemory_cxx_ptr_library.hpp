@@ -28,7 +28,22 @@
 
 #include <timemory/library.h>
 
+// records started and not yet ended on the calling thread (one counter per library)
+__attribute__((weak, visibility("hidden"))) __thread int64_t inst_tim_ptr_depth = 0;
+
 #define INSTRUMENT_CONFIGURE() timemory_set_default("wall_clock");
 #define INSTRUMENT_CREATE(...) uint64_t inst_id;
-#define INSTRUMENT_START(...) timemory_begin_record(__FUNCTION__, &inst_id);
-#define INSTRUMENT_STOP(...) timemory_end_record(inst_id);
+#define INSTRUMENT_START(...)                                                            \
+    timemory_begin_record(__FUNCTION__, &inst_id);                                       \
+    ++inst_tim_ptr_depth;
+#define INSTRUMENT_STOP(...)                                                             \
+    timemory_end_record(inst_id);                                                        \
+    --inst_tim_ptr_depth;
+#define INSTRUMENT_CREATE_LABEL(label) uint64_t inst_id;
+#define INSTRUMENT_START_LABEL(label)                                                    \
+    timemory_begin_record(label, &inst_id);                                              \
+    ++inst_tim_ptr_depth;
+#define INSTRUMENT_STOP_LABEL(label)                                                     \
+    timemory_end_record(inst_id);                                                        \
+    --inst_tim_ptr_depth;
+#define INSTRUMENT_QUERY_DEPTH() inst_tim_ptr_depth
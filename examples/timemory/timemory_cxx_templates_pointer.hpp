@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 
@@ -30,7 +31,29 @@ using namespace tim::component;
 // using toolset_t = tim::auto_timer;
 using toolset_t = tim::auto_tuple<wall_clock>;
 
+// pointers alive on the calling thread (one counter per library); the guard is
+// destroyed with the pointer, also when an exception unwinds the scope
+__attribute__((weak, visibility("hidden"))) __thread int64_t inst_tim_pointer_depth = 0;
+
+struct inst_tim_pointer_guard
+{
+    inst_tim_pointer_guard() { ++inst_tim_pointer_depth; }
+    ~inst_tim_pointer_guard() { --inst_tim_pointer_depth; }
+};
+
+#if !defined(INST_TIM_CAT)
+#    define INST_TIM_JOIN(a, b) a##b
+#    define INST_TIM_CAT(a, b) INST_TIM_JOIN(a, b)
+#endif
+
 #define INSTRUMENT_CONFIGURE()
 #define INSTRUMENT_CREATE(...)
-#define INSTRUMENT_START(name) TIMEMORY_BASIC_POINTER(toolset_t, "");
+#define INSTRUMENT_START(name)                                                           \
+    TIMEMORY_BASIC_POINTER(toolset_t, "");                                               \
+    inst_tim_pointer_guard INST_TIM_CAT(inst_tim_guard_, __LINE__);
 #define INSTRUMENT_STOP(...)
+#define INSTRUMENT_START_LABEL(label)                                                    \
+    TIMEMORY_BASIC_POINTER(toolset_t, "/", label);                                       \
+    inst_tim_pointer_guard INST_TIM_CAT(inst_tim_guard_, __LINE__);
+#define INSTRUMENT_STOP_LABEL(label)
+#define INSTRUMENT_QUERY_DEPTH() inst_tim_pointer_depth
@@ -0,0 +1,126 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+//--------------------------------------------------------------------------------------//
+/// ordinary least-squares fit of y = intercept + slope * x with standard errors
+struct linear_fit
+{
+    using dvec_t = std::vector<double>;
+
+    int64_t npoints       = 0;
+    double  intercept     = 0.0;
+    double  slope         = 0.0;
+    double  intercept_err = std::numeric_limits<double>::quiet_NaN();
+    double  slope_err     = std::numeric_limits<double>::quiet_NaN();
+    double  r2            = std::numeric_limits<double>::quiet_NaN();
+    // standard deviation of the residuals
+    double residual = std::numeric_limits<double>::quiet_NaN();
+
+    linear_fit() = default;
+
+    linear_fit(const dvec_t& x, const dvec_t& y)
+    : npoints(static_cast<int64_t>(std::min(x.size(), y.size())))
+    {
+        if(npoints == 0)
+            return;
+
+        double n     = static_cast<double>(npoints);
+        double xmean = 0.0;
+        double ymean = 0.0;
+        for(int64_t i = 0; i < npoints; ++i)
+        {
+            xmean += x[i];
+            ymean += y[i];
+        }
+        xmean /= n;
+        ymean /= n;
+
+        double sxx = 0.0;
+        double sxy = 0.0;
+        double syy = 0.0;
+        for(int64_t i = 0; i < npoints; ++i)
+        {
+            sxx += (x[i] - xmean) * (x[i] - xmean);
+            sxy += (x[i] - xmean) * (y[i] - ymean);
+            syy += (y[i] - ymean) * (y[i] - ymean);
+        }
+
+        // all x identical: only the mean is defined
+        if(sxx <= 0.0)
+        {
+            intercept = ymean;
+            return;
+        }
+
+        slope     = sxy / sxx;
+        intercept = ymean - slope * xmean;
+
+        double sse = 0.0;
+        for(int64_t i = 0; i < npoints; ++i)
+        {
+            double r = y[i] - (intercept + slope * x[i]);
+            sse += r * r;
+        }
+
+        if(syy > 0.0)
+            r2 = 1.0 - sse / syy;
+
+        // two parameters were estimated
+        if(npoints > 2)
+        {
+            double s2     = sse / (n - 2.0);
+            residual      = std::sqrt(s2);
+            slope_err     = std::sqrt(s2 / sxx);
+            intercept_err = std::sqrt(s2 * (1.0 / n + xmean * xmean / sxx));
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+/// mean and standard error of the mean
+inline std::pair<double, double>
+mean_and_error(const std::vector<double>& y)
+{
+    double n    = static_cast<double>(y.size());
+    double mean = 0.0;
+    for(const auto& itr : y)
+        mean += itr;
+    if(y.empty())
+        return std::make_pair(mean, std::numeric_limits<double>::quiet_NaN());
+    mean /= n;
+    if(y.size() < 2)
+        return std::make_pair(mean, std::numeric_limits<double>::quiet_NaN());
+    double var = 0.0;
+    for(const auto& itr : y)
+        var += (itr - mean) * (itr - mean);
+    var /= (n - 1.0);
+    return std::make_pair(mean, std::sqrt(var / n));
+}
@@ -0,0 +1,45 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Deterministic busy-work shared by the kernels (C and C++): `iterations` dependent
+// updates of a 64-bit linear congruential generator. Every iteration depends on the
+// previous one so the loop is neither folded nor vectorized, and instrumented and
+// uninstrumented runs with the same seed and iterations produce the same value.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+//--------------------------------------------------------------------------------------//
+
+static inline uint64_t
+busy_work(uint64_t seed, int64_t iterations)
+{
+    uint64_t val = seed;
+    for(int64_t i = 0; i < iterations; ++i)
+        val = val * 6364136223846793005ULL + 1442695040888963407ULL;
+    return val;
+}
+
+//--------------------------------------------------------------------------------------//
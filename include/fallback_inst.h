@@ -22,6 +22,19 @@
 
 #pragma once
 
+#include <stdint.h>
+
+// compiler-inserted instrumentation (-finstrument-functions): the manual markers of the
+// tests are compiled out and the __cyg_profile_func_enter/exit shim is used instead
+#if defined(INSTRUMENT_MARKERS_DISABLED)
+#    undef INSTRUMENT_CREATE
+#    undef INSTRUMENT_START
+#    undef INSTRUMENT_STOP
+#    undef INSTRUMENT_CREATE_LABEL
+#    undef INSTRUMENT_START_LABEL
+#    undef INSTRUMENT_STOP_LABEL
+#endif
+
 // configure tool before any tests are run
 #if !defined(INSTRUMENT_CONFIGURE)
 #    define INSTRUMENT_CONFIGURE()
@@ -41,3 +54,48 @@
 #if !defined(INSTRUMENT_STOP)
 #    define INSTRUMENT_STOP(...)
 #endif
+
+// create/start/stop a region named by a string label, which must stay valid until
+// INSTRUMENT_FINALIZE() (e.g. from persistent_label). Tools which do not name regions
+// fall back to the macros above
+#if !defined(INSTRUMENT_CREATE_LABEL)
+#    define INSTRUMENT_CREATE_LABEL(label) INSTRUMENT_CREATE(label)
+#endif
+
+#if !defined(INSTRUMENT_START_LABEL)
+#    define INSTRUMENT_START_LABEL(label) INSTRUMENT_START(label)
+#endif
+
+#if !defined(INSTRUMENT_STOP_LABEL)
+#    define INSTRUMENT_STOP_LABEL(label) INSTRUMENT_STOP(label)
+#endif
+
+// entry/exit of a function compiled with -finstrument-functions (address of the function)
+#if !defined(INSTRUMENT_ENTER)
+#    define INSTRUMENT_ENTER(...)
+#endif
+
+#if !defined(INSTRUMENT_EXIT)
+#    define INSTRUMENT_EXIT(...)
+#endif
+
+// depth of the region stack of the tool on the calling thread (may be negative when
+// regions are stopped on other threads), INSTRUMENT_DEPTH_UNKNOWN if not known
+#if !defined(INSTRUMENT_DEPTH_UNKNOWN)
+#    define INSTRUMENT_DEPTH_UNKNOWN INT64_MIN
+#endif
+
+#if !defined(INSTRUMENT_QUERY_DEPTH)
+#    define INSTRUMENT_QUERY_DEPTH() INSTRUMENT_DEPTH_UNKNOWN
+#endif
+
+// suspend any activity of the tool that is not tied to a region (e.g. timers) after
+// each test, INSTRUMENT_CONFIGURE() is invoked before the next one
+#if !defined(INSTRUMENT_SUSPEND)
+#    define INSTRUMENT_SUSPEND()
+#endif
+
+// finalize tool (flush/write output) after all tests are run
+#if !defined(INSTRUMENT_FINALIZE)
+#    define INSTRUMENT_FINALIZE()
+#endif
@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Hot functions of a bundled shared library for the function-interposition benchmark.
+//
+// HOTLIB_SYMBOLS(X) expands X(N) for every exported function hotlib_fn_<N>. Each one
+// does `work` iterations of a dependent integer update, so the cost of the wrapped
+// function is a parameter of the test.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#define HOTLIB_NSYMBOLS 64
+
+// clang-format off
+#define HOTLIB_SYMBOLS(X)                                                                \
+    X(0)  X(1)  X(2)  X(3)  X(4)  X(5)  X(6)  X(7)                                       \
+    X(8)  X(9)  X(10) X(11) X(12) X(13) X(14) X(15)                                      \
+    X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23)                                      \
+    X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31)                                      \
+    X(32) X(33) X(34) X(35) X(36) X(37) X(38) X(39)                                      \
+    X(40) X(41) X(42) X(43) X(44) X(45) X(46) X(47)                                      \
+    X(48) X(49) X(50) X(51) X(52) X(53) X(54) X(55)                                      \
+    X(56) X(57) X(58) X(59) X(60) X(61) X(62) X(63)
+// clang-format on
+
+#define HOTLIB_DECLARE(N) uint64_t hotlib_fn_##N(uint64_t, int64_t);
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+    typedef uint64_t (*hotlib_fn_t)(uint64_t, int64_t);
+
+    HOTLIB_SYMBOLS(HOTLIB_DECLARE)
+
+    /// calls hotlib_fn_0 ... hotlib_fn_<nsymbols - 1> round-robin, ncalls times in
+    /// total, through the PLT of the caller library
+    uint64_t hotcall_run(int64_t nsymbols, int64_t ncalls, int64_t work, uint64_t seed);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -30,7 +30,7 @@
 #if !defined(__cplusplus)
 //--------------------------------------------------------------------------------------//
 /// get the time
-inline double
+static inline double
 wtime()
 {
     struct timeval now;
@@ -55,13 +55,33 @@ extern "C"
         double*  inst_per_sec;
     } c_runtime_data;
 
+    //--------------------------------------------------------------------------------------//
+    /// data on a single completed timing entry (streamed while the test runs)
+    typedef struct _trial_record
+    {
+        int64_t index;
+        int64_t inst_count;
+        double  timing;
+        double  inst_per_sec;
+    } c_trial_record;
+
+    //--------------------------------------------------------------------------------------//
+    /// invoked after each timing entry, outside of the timed region. Return non-zero to
+    /// stop the test early. Between the uninstrumented warm-up entries the record is NULL
+    typedef int (*c_trial_callback)(const c_trial_record*, void*);
+
     //--------------------------------------------------------------------------------------//
     /// execute a test
     c_runtime_data c_execute_matmul(int64_t s, int64_t max, int64_t nitr);
 
+    //--------------------------------------------------------------------------------------//
+    /// execute a test and stream each entry to a callback (may be NULL)
+    c_runtime_data c_execute_matmul_stream(int64_t s, int64_t max, int64_t nitr,
+                                           c_trial_callback callback, void* user_data);
+
     //--------------------------------------------------------------------------------------//
 
-    inline void init_runtime_data(int64_t nentries, c_runtime_data* data)
+    static inline void init_runtime_data(int64_t nentries, c_runtime_data* data)
     {
         data->entries      = nentries;
         data->inst_count   = (int64_t*) malloc(nentries * sizeof(int64_t));
@@ -75,7 +95,7 @@ extern "C"
 
     //--------------------------------------------------------------------------------------//
 
-    inline void free_runtime_data(c_runtime_data data)
+    static inline void free_runtime_data(c_runtime_data data)
     {
         free(data.inst_count);
         free(data.timing);
@@ -20,16 +20,27 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#pragma once
+
+#include <atomic>
 #include <chrono>
 #include <cinttypes>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <ratio>
+#include <set>
+#include <string>
 #include <sys/time.h>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include "busy_work.h"
+
 #if defined(__cplusplus)
 //--------------------------------------------------------------------------------------//
 // the system's real time (i.e. wall time) clock, expressed as the amount of time since
@@ -44,6 +55,39 @@ wtime()
                .count() /
            static_cast<_Tp>(std::nano::den);
 }
+
+//--------------------------------------------------------------------------------------//
+// kernels select their uninstrumented (none) and instrumented (inst) variants with these
+// tags. They are unique to each translation unit so that the templates of different
+// kernels instantiated with them never collide. A kernel with more variants adds its
+// own tags to the namespace
+namespace
+{
+namespace mode
+{
+// clang-format off
+struct none {};
+struct inst {};
+// clang-format on
+}  // namespace mode
+}  // namespace
+
+template <bool _Ret, typename _Tp = int>
+using enable_if = typename std::enable_if<_Ret, _Tp>::type;
+
+//--------------------------------------------------------------------------------------//
+// copy of a label for the INSTRUMENT_*_LABEL macros which stays valid until the process
+// exits (tools may keep the pointer until INSTRUMENT_FINALIZE). Equal labels return the
+// same pointer. It locks and allocates, so build the labels outside of the timed regions
+inline const char*
+persistent_label(const std::string& _label)
+{
+    // never destroyed so that the labels outlive the tools finalized at exit
+    static std::mutex             _mutex;
+    static std::set<std::string>* _labels = new std::set<std::string>{};
+    std::lock_guard<std::mutex>   _lock(_mutex);
+    return _labels->insert(_label).first->c_str();
+}
 #endif
 
 //--------------------------------------------------------------------------------------//
@@ -59,6 +103,8 @@ struct cxx_runtime_data
     ivec_t  inst_count;
     dvec_t  timing;
     dvec_t  inst_per_sec;
+    // additional per-test quantities (e.g. memory), keyed by name
+    std::map<std::string, double> metrics;
 
     cxx_runtime_data()                        = default;
     ~cxx_runtime_data()                       = default;
@@ -75,6 +121,15 @@ struct cxx_runtime_data
     {
     }
 
+    // truncate to the number of entries actually completed (e.g. after an interrupt)
+    void resize(int64_t _entries)
+    {
+        entries = _entries;
+        inst_count.resize(entries);
+        timing.resize(entries);
+        inst_per_sec.resize(entries);
+    }
+
     cxx_runtime_data& operator/=(const std::tuple<int64_t, int64_t>& _div)
     {
         auto idx = std::get<0>(_div);
@@ -108,14 +163,205 @@ struct cxx_runtime_data
 };
 
 //--------------------------------------------------------------------------------------//
-/// execute a matrix multiply test
+/// data on a single completed timing entry: index, inst_count, timing, inst_per_sec
+using cxx_trial_record = cxx_runtime_data::result_t;
+
+//--------------------------------------------------------------------------------------//
+/// cooperative control of a running test. The flag is only checked and the callback
+/// is only invoked between timing entries so neither perturbs the measured region
+struct cxx_runtime_control
+{
+    // return false to stop the test early
+    using callback_t = std::function<bool(const cxx_trial_record&)>;
+    // receives the index of the entry about to be timed
+    using prepare_t = std::function<void(int64_t)>;
+
+    std::atomic<bool> interrupt;
+    callback_t        callback;
+    prepare_t         prepare;
+
+    cxx_runtime_control()
+    : interrupt(false)
+    {
+    }
+
+    bool interrupted() const { return interrupt.load(std::memory_order_relaxed); }
+
+    // invoked immediately before an instrumented entry is timed (e.g. a barrier)
+    void begin(int64_t _idx)
+    {
+        if(prepare)
+            prepare(_idx);
+    }
+
+    // report a completed entry, returns false if the test should stop
+    bool notify(const cxx_trial_record& _record)
+    {
+        if(callback && !callback(_record))
+            interrupt.store(true);
+        return !interrupted();
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+/// costs of a tool outside of the instrumented regions
+struct cxx_lifecycle_data
+{
+    int64_t nregions     = 0;
+    double  configure    = 0.0;  // INSTRUMENT_CONFIGURE()
+    double  first_region = 0.0;  // first create/start/stop
+    double  regions      = 0.0;  // the remaining nregions - 1 regions
+    double  finalize     = 0.0;  // INSTRUMENT_FINALIZE()
+    double  exit_begin   = 0.0;  // wtime() when finalize returned
+};
+
+//--------------------------------------------------------------------------------------//
+/// execute a matrix multiply test. If provided, reference receives the timing of the
+/// uninstrumented (warm-up) entries
+///
+cxx_runtime_data
+cxx_execute_matmul(int64_t s, int64_t max, int64_t nitr,
+                   cxx_runtime_control* ctrl = nullptr,
+                   cxx_runtime_data*    reference = nullptr);
+
+/// execute a fibonacci test. If provided, reference receives the timing of the
+/// uninstrumented (warm-up) entries
+///
+cxx_runtime_data
+cxx_execute_fibonacci(int64_t nfib, int64_t cutoff, int64_t nitr,
+                      cxx_runtime_control* ctrl      = nullptr,
+                      cxx_runtime_data*    reference = nullptr);
+
+/// execute a synthetic region tree: depth levels of fanout regions each, where the last
+/// region of a level contains the next level and the others do `work` iterations of
+/// leaf work. Labels are distinct per region or the same for every region. If
+/// provided, reference receives the timing of the uninstrumented entries
+///
+cxx_runtime_data
+cxx_execute_region_tree(int64_t depth, int64_t fanout, int64_t work, bool distinct,
+                        int64_t nitr, cxx_runtime_control* ctrl = nullptr,
+                        cxx_runtime_data* reference = nullptr);
+
+/// replay a recorded trace of (thread, label, start/stop, work) events with calibrated
+/// busy-work between the events. Binary traces are memory-mapped, CSV traces are
+/// parsed. If provided, reference receives the timing of the uninstrumented replays
+///
+cxx_runtime_data
+cxx_execute_trace_replay(const std::string& path, int64_t nitr,
+                         cxx_runtime_control* ctrl      = nullptr,
+                         cxx_runtime_data*    reference = nullptr);
+
+/// calls the hot functions of a bundled shared library (nsymbols distinct functions,
+/// ncalls calls of `work` iterations each per entry) directly, through LD_PRELOAD-style
+/// wrappers, through rewritten GOT entries and through rewritten GOT entries which
+/// start/stop a region. Each mode runs in a forked process. Returns the instrumented
+/// mode with the per-call cost of every mode in the metrics. If provided, reference
+/// receives the timing of the direct calls
+///
+cxx_runtime_data
+cxx_execute_interpose(int64_t nsymbols, int64_t ncalls, int64_t work, int64_t nitr,
+                      cxx_runtime_control* ctrl      = nullptr,
+                      cxx_runtime_data*    reference = nullptr);
+
+/// a single region wrapping `work` iterations, called once per region from python to
+/// measure the cost of crossing the language boundary. The batched versions run the
+/// regions with labels 0 ... nregions - 1 in a native loop and return the sum modulo
+/// 2^64 (the sum of the per-call results in python masked to 64 bits)
+///
+int64_t
+cxx_boundary_region(int64_t label, int64_t work);
+
+int64_t
+cxx_boundary_region_none(int64_t label, int64_t work);
+
+uint64_t
+cxx_boundary_batch(int64_t nregions, int64_t work);
+
+uint64_t
+cxx_boundary_batch_none(int64_t nregions, int64_t work);
+
+/// execute fib(nfib) with regions above the cutoff, where each leaf throws with
+/// probability rate and the exception is caught by the closest region more than
+/// `levels` regions above the leaf. The cost of unwinding is measured w.r.t. returning
+/// the same errors through every level, with and without instrumentation, and the
+/// region depth of the tool is checked at every catch. If provided, reference receives
+/// the timing of the uninstrumented entries which throw
+///
+cxx_runtime_data
+cxx_execute_unwind(int64_t nfib, int64_t cutoff, double rate, int64_t levels,
+                   int64_t nitr, cxx_runtime_control* ctrl = nullptr,
+                   cxx_runtime_data* reference = nullptr);
+
+/// create nthreads short-lived threads in sequence, each running nregions regions of
+/// `work` iterations before it exits, and report the per-thread set-up and tear-down
+/// cost and the memory retained by the tool. If provided, reference receives the timing
+/// of the uninstrumented entries
+///
+cxx_runtime_data
+cxx_execute_thread_churn(int64_t nthreads, int64_t nregions, int64_t work, int64_t nitr,
+                         cxx_runtime_control* ctrl      = nullptr,
+                         cxx_runtime_data*    reference = nullptr);
+
+/// invoke nlabels labels never seen by the tool ncold + nwarm times each and report the
+/// latency of the first ncold invocations of every label separately from the steady
+/// state. When flush_bytes > 0, a buffer of that size is written and read before every
+/// cold invocation to evict the caches. If provided, reference receives the timing of
+/// the uninstrumented entries
+///
+cxx_runtime_data
+cxx_execute_first_call(int64_t nlabels, int64_t ncold, int64_t nwarm, int64_t work,
+                       int64_t flush_bytes, int64_t nitr,
+                       cxx_runtime_control* ctrl      = nullptr,
+                       cxx_runtime_data*    reference = nullptr);
+
+/// run nregions regions of `work` iterations on each of nthreads threads at once where
+/// all the threads share one label, every thread uses its own label, or a fraction
+/// (overlap) of the regions of every thread use the shared label. Reports the throughput
+/// (regions per second per thread) of each pattern and the penalty of sharing a label.
+/// If provided, reference receives the timing of the uninstrumented entries
 ///
 cxx_runtime_data
-cxx_execute_matmul(int64_t s, int64_t max, int64_t nitr);
+cxx_execute_contention(int64_t nthreads, int64_t nregions, int64_t work, double overlap,
+                       int64_t nitr, cxx_runtime_control* ctrl = nullptr,
+                       cxx_runtime_data* reference = nullptr);
 
-/// execute a fibonacci tets
+/// write nbytes to a temporary file and read them back (page cache) nops times per
+/// entry, with an fsync after every fsync_every-th write (0 = never) and a region around
+/// every operation. The file is created in directory, or a tmpfs (/dev/shm) if empty.
+/// Reports the overhead w.r.t. the syscall latency and the context switches of the
+/// process. If provided, reference receives the timing of the uninstrumented entries
 ///
 cxx_runtime_data
-cxx_execute_fibonacci(int64_t nfib, int64_t cutoff, int64_t nitr);
+cxx_execute_syscall_io(int64_t nops, int64_t nbytes, int64_t fsync_every,
+                       const std::string& directory, int64_t nitr,
+                       cxx_runtime_control* ctrl      = nullptr,
+                       cxx_runtime_data*    reference = nullptr);
+
+/// walk nsteps nodes of a randomized linked structure of nnodes nodes, where the work
+/// and the successor of every node depend on the data, with a fraction (density) of the
+/// nodes instrumented. Reports the overhead per call and, where hardware counters are
+/// available, the branch-miss and iTLB-miss deltas w.r.t. the uninstrumented walk. If
+/// provided, reference receives the timing of the uninstrumented entries
+///
+cxx_runtime_data
+cxx_execute_pointer_chase(int64_t nnodes, int64_t nsteps, double density, int64_t nitr,
+                          cxx_runtime_control* ctrl      = nullptr,
+                          cxx_runtime_data*    reference = nullptr);
+
+/// execute ntasks pipelined coroutines of nstages regions on nthreads executor threads.
+/// Every region suspends halfway through its work and may be resumed (and stopped) on
+/// another thread. Only available when built with USE_COROUTINES (C++20). If provided,
+/// reference receives the timing of the uninstrumented entries
+///
+cxx_runtime_data
+cxx_execute_coroutine(int64_t ntasks, int64_t nstages, int64_t work, int64_t nthreads,
+                      int64_t nitr, cxx_runtime_control* ctrl = nullptr,
+                      cxx_runtime_data* reference = nullptr);
+
+/// time the configuration of the tool, the first region, nregions distinct regions
+/// and the finalization of the tool. Intended to run in a fresh (forked) process
+///
+cxx_lifecycle_data
+cxx_execute_lifecycle(int64_t nregions);
 
 //--------------------------------------------------------------------------------------//
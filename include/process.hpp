@@ -0,0 +1,377 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "process-shared atomics require lock-free 64-bit integers");
+
+//--------------------------------------------------------------------------------------//
+/// anonymous memory shared with forked child processes. _Tp must be trivially
+/// destructible since the children never run destructors
+template <typename _Tp>
+struct shared_segment
+{
+    explicit shared_segment(size_t _size)
+    : size(_size)
+    {
+        void* _ptr = mmap(nullptr, size * sizeof(_Tp), PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if(_ptr == MAP_FAILED)
+            throw std::runtime_error(std::string("mmap failed: ") + strerror(errno));
+        data = static_cast<_Tp*>(_ptr);
+        for(size_t i = 0; i < size; ++i)
+            new(data + i) _Tp();
+    }
+
+    ~shared_segment() { munmap(data, size * sizeof(_Tp)); }
+
+    shared_segment(const shared_segment&) = delete;
+    shared_segment& operator=(const shared_segment&) = delete;
+
+    _Tp&       operator[](size_t i) { return data[i]; }
+    const _Tp& operator[](size_t i) const { return data[i]; }
+
+    size_t size = 0;
+    _Tp*   data = nullptr;
+};
+
+//--------------------------------------------------------------------------------------//
+/// spinning barrier placed in a shared_segment. Any process can abort the barrier so
+/// a failing worker does not dead-lock the others
+struct process_barrier
+{
+    std::atomic<int64_t> count;
+    std::atomic<int64_t> generation;
+    std::atomic<int64_t> aborted;
+    int64_t              nproc;
+
+    process_barrier()
+    : count(0)
+    , generation(0)
+    , aborted(0)
+    , nproc(1)
+    {
+    }
+
+    // returns false if the barrier was aborted
+    bool wait()
+    {
+        auto _gen = generation.load();
+        if(count.fetch_add(1) + 1 == nproc)
+        {
+            count.store(0);
+            generation.fetch_add(1);
+            return aborted.load() == 0;
+        }
+        while(generation.load() == _gen)
+        {
+            if(aborted.load() != 0)
+                return false;
+            sched_yield();
+        }
+        return aborted.load() == 0;
+    }
+
+    void abort() { aborted.store(1); }
+};
+
+//--------------------------------------------------------------------------------------//
+/// a timing entry written by a worker process
+struct process_record
+{
+    int64_t inst_count = 0;
+    double  timing     = 0.0;
+    double  baseline   = 0.0;
+    int64_t complete   = 0;
+};
+
+//--------------------------------------------------------------------------------------//
+/// pin the calling thread to a CPU (negative value is a no-op). Used for the
+/// background thread of an async test and for a forked worker process, whose only
+/// thread is the calling thread
+inline void
+pin_thread(int64_t cpu)
+{
+#if defined(__linux__)
+    if(cpu < 0)
+        return;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#else
+    (void) cpu;
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+/// reaps the given child processes in the order they exit (not the order given) so
+/// a failure can be handled while the remaining processes are still running
+template <typename _Func>
+void
+wait_processes(std::vector<pid_t> pids, _Func&& on_exit)
+{
+    while(!pids.empty())
+    {
+        bool _reaped = false;
+        for(auto itr = pids.begin(); itr != pids.end();)
+        {
+            int   status = 0;
+            pid_t ret    = waitpid(*itr, &status, WNOHANG);
+            if(ret == *itr || (ret < 0 && errno != EINTR))
+            {
+                on_exit(*itr, (ret < 0) ? -1 : status);
+                itr     = pids.erase(itr);
+                _reaped = true;
+            }
+            else
+                ++itr;
+        }
+        if(!_reaped)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+/// executes func in a forked child process and returns its result, which must be
+/// trivially copyable. The child leaves with _exit() so nothing inherited from the
+/// parent (e.g. python or a configured tool) is finalized twice. While the child runs,
+/// poll is invoked in the parent every millisecond and once more after the child
+/// exited (e.g. to forward the entries the child writes to shared memory)
+///
+template <typename _Tp, typename _Func>
+_Tp
+cxx_execute_forked(_Func&& func, std::function<void()> poll = std::function<void()>{})
+{
+    struct result_t
+    {
+        _Tp     value;
+        int64_t complete = 0;
+        char    message[256];
+    };
+
+    shared_segment<result_t> result(1);
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if(pid < 0)
+        throw std::runtime_error(std::string("fork failed: ") + strerror(errno));
+
+    if(pid == 0)
+    {
+        int ret = 0;
+        try
+        {
+            result[0].value    = func();
+            result[0].complete = 1;
+        } catch(std::exception& e)
+        {
+            strncpy(result[0].message, e.what(), sizeof(result[0].message) - 1);
+            ret = 1;
+        }
+        fflush(stdout);
+        fflush(stderr);
+        _exit(ret);
+    }
+
+    int status = 0;
+    if(poll)
+    {
+        pid_t ret = 0;
+        while((ret = waitpid(pid, &status, WNOHANG)) == 0 || (ret < 0 && errno == EINTR))
+        {
+            poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        poll();
+    }
+    else
+    {
+        while(waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        {
+        }
+    }
+
+    if(!result[0].complete)
+    {
+        std::stringstream ss;
+        ss << "forked process failed";
+        if(strlen(result[0].message) > 0)
+            ss << ": " << result[0].message;
+        else if(WIFSIGNALED(status))
+            ss << ": signal " << WTERMSIG(status);
+        throw std::runtime_error(ss.str());
+    }
+    return result[0].value;
+}
+
+//--------------------------------------------------------------------------------------//
+/// forks nproc worker processes, each pinned to cpus[rank % cpus.size()] (or rank if
+/// cpus is empty), executing func with a barrier across all workers before every
+/// timed entry. func receives the control and the reference of the rank, which it
+/// fills with the uninstrumented entries. The entries are written to shared memory
+/// and returned per rank; if provided, reference receives the uninstrumented entries
+/// of each rank. The workers never return to the caller (they _exit), so func must
+/// not depend on any state that is unsafe after fork (e.g. Python)
+///
+inline std::vector<cxx_runtime_data>
+cxx_execute_multiprocess(
+    int64_t nproc, int64_t nitr, std::vector<int64_t> cpus,
+    std::function<cxx_runtime_data(cxx_runtime_control*, cxx_runtime_data*)> func,
+    std::vector<cxx_runtime_data>* reference = nullptr)
+{
+    if(nproc < 1)
+        throw std::runtime_error("multiprocess execution requires at least one process");
+
+    if(cpus.empty())
+    {
+        int64_t ncpu = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+        for(int64_t i = 0; i < nproc; ++i)
+            cpus.push_back(i % ncpu);
+    }
+
+    shared_segment<process_barrier> barrier(1);
+    shared_segment<process_record>  records(nproc * nitr);
+    barrier[0].nproc = nproc;
+
+    // don't duplicate buffered output in the children
+    fflush(stdout);
+    fflush(stderr);
+
+    std::vector<pid_t> pids;
+    for(int64_t rank = 0; rank < nproc; ++rank)
+    {
+        pid_t pid = fork();
+        if(pid < 0)
+        {
+            barrier[0].abort();
+            break;
+        }
+
+        if(pid == 0)
+        {
+            int ret = 0;
+            try
+            {
+                pin_thread(cpus.at(rank % cpus.size()));
+                cxx_runtime_control ctrl;
+                ctrl.prepare = [&](int64_t) {
+                    if(!barrier[0].wait())
+                        throw std::runtime_error("barrier aborted by another worker");
+                };
+                ctrl.callback = [&](const cxx_trial_record& _record) {
+                    auto  idx      = std::get<0>(_record);
+                    auto& rec      = records[rank * nitr + idx];
+                    rec.inst_count = std::get<1>(_record);
+                    rec.timing     = std::get<2>(_record);
+                    rec.complete   = 1;
+                    return true;
+                };
+                cxx_runtime_data _reference(0);
+                func(&ctrl, &_reference);
+                for(int64_t i = 0; i < std::min(_reference.entries, nitr); ++i)
+                    records[rank * nitr + i].baseline = _reference.timing[i];
+            } catch(std::exception& e)
+            {
+                fprintf(stderr, "[rank %lli]> %s\n", (long long) rank, e.what());
+                barrier[0].abort();
+                ret = 1;
+            }
+            fflush(stdout);
+            fflush(stderr);
+            _exit(ret);
+        }
+
+        pids.push_back(pid);
+    }
+
+    int64_t nfail = (static_cast<int64_t>(pids.size()) < nproc) ? 1 : 0;
+    wait_processes(pids, [&](pid_t, int status) {
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            // unblock any worker still waiting on the failed one
+            barrier[0].abort();
+            ++nfail;
+        }
+    });
+
+    if(nfail > 0)
+    {
+        std::stringstream ss;
+        ss << nfail << " of " << nproc << " worker processes failed";
+        throw std::runtime_error(ss.str());
+    }
+
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+    std::vector<cxx_runtime_data> data;
+    if(reference)
+        reference->clear();
+    for(int64_t rank = 0; rank < nproc; ++rank)
+    {
+        cxx_runtime_data _data(nitr);
+        cxx_runtime_data _base(nitr);
+        int64_t          ncomplete = 0;
+        for(int64_t i = 0; i < nitr; ++i)
+        {
+            const auto& rec = records[rank * nitr + i];
+            if(!rec.complete)
+                break;
+            _data += entry_t(i, rec.inst_count, rec.timing);
+            _base += entry_t(i, 0, rec.baseline);
+            ++ncomplete;
+        }
+        _data.resize(ncomplete);
+        _base.resize(ncomplete);
+        data.push_back(_data);
+        if(reference)
+            reference->push_back(_base);
+    }
+    return data;
+}
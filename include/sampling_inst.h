@@ -0,0 +1,315 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+//
+// Reference submodule: statistical sampling instead of instrumentation.
+//
+// INSTRUMENT_CONFIGURE() arms a SIGPROF timer and the signal handler records the
+// interrupted program counter into a lock-free ring buffer. The regions themselves are
+// not instrumented so the difference w.r.t. the baseline submodule is the cost of the
+// sampling (signal delivery + handler) and the perturbation it causes in the kernels.
+// INSTRUMENT_SUSPEND() stops the timer after each test so other submodules are not
+// sampled. INSTRUMENT_FINALIZE() reports the functions with the most samples.
+//
+// Environment:
+//      INSTRUMENT_SAMPLING_FREQUENCY   sampling frequency in Hz
+//      INSTRUMENT_SAMPLING_CLOCK       "cpu" (default): setitimer(ITIMER_PROF), i.e. CPU
+//                                      time of the process, limited by the kernel tick
+//                                      "realtime": timer_create(CLOCK_MONOTONIC), i.e.
+//                                      high-resolution wall-clock (linux only)
+//
+
+#pragma once
+
+#if !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#if defined(__cplusplus)
+#    include <cxxabi.h>
+#endif
+
+// default sampling frequency (Hz)
+#if !defined(INSTRUMENT_SAMPLING_FREQUENCY)
+#    define INSTRUMENT_SAMPLING_FREQUENCY 1000
+#endif
+
+// number of program counters kept (power of two), older samples are overwritten
+#if !defined(INSTRUMENT_SAMPLING_RING_SIZE)
+#    define INSTRUMENT_SAMPLING_RING_SIZE (1 << 16)
+#endif
+
+// number of functions reported at finalization
+#if !defined(INSTRUMENT_SAMPLING_REPORT_SIZE)
+#    define INSTRUMENT_SAMPLING_REPORT_SIZE 10
+#endif
+
+// state is shared by every translation unit (and library) including this header
+#define INST_SAMPLING_SHARED __attribute__((weak, visibility("default")))
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+    INST_SAMPLING_SHARED uintptr_t inst_sampling_ring[INSTRUMENT_SAMPLING_RING_SIZE];
+    INST_SAMPLING_SHARED uint64_t  inst_sampling_count;
+    INST_SAMPLING_SHARED double    inst_sampling_freq;
+#if defined(__linux__)
+    INST_SAMPLING_SHARED timer_t inst_sampling_timer;
+    INST_SAMPLING_SHARED pid_t   inst_sampling_timer_pid;
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+/// program counter of the interrupted context (zero if the architecture is unknown)
+static inline uintptr_t
+inst_sampling_pc(void* context)
+{
+    ucontext_t* _uc = (ucontext_t*) context;
+#if defined(__linux__) && defined(__x86_64__)
+    return (uintptr_t) _uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__linux__) && defined(__i386__)
+    return (uintptr_t) _uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__linux__) && defined(__aarch64__)
+    return (uintptr_t) _uc->uc_mcontext.pc;
+#elif defined(__linux__) && defined(__powerpc64__)
+    return (uintptr_t) _uc->uc_mcontext.regs->nip;
+#else
+    (void) _uc;
+    return 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+/// signal handler: one relaxed fetch-add and one store, no locks or allocation
+static inline void
+inst_sampling_handler(int sig, siginfo_t* info, void* context)
+{
+    uint64_t _idx = __atomic_fetch_add(&inst_sampling_count, 1, __ATOMIC_RELAXED);
+    inst_sampling_ring[_idx & (INSTRUMENT_SAMPLING_RING_SIZE - 1)] =
+        inst_sampling_pc(context);
+    (void) sig;
+    (void) info;
+}
+
+//--------------------------------------------------------------------------------------//
+/// stop the timers. The handler stays installed so a signal in flight is not fatal
+static inline void
+inst_sampling_stop(void)
+{
+    struct itimerval _zero;
+    memset(&_zero, 0, sizeof(_zero));
+    setitimer(ITIMER_PROF, &_zero, NULL);
+#if defined(__linux__)
+    if(inst_sampling_timer_pid == getpid())
+    {
+        struct itimerspec _spec;
+        memset(&_spec, 0, sizeof(_spec));
+        timer_settime(inst_sampling_timer, 0, &_spec, NULL);
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+/// install the handler and (re-)arm the timer. Timers are not inherited by forked
+/// processes so this is done on every call
+static inline void
+inst_sampling_configure(void)
+{
+    struct sigaction _action;
+    memset(&_action, 0, sizeof(_action));
+    _action.sa_sigaction = inst_sampling_handler;
+    _action.sa_flags     = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&_action.sa_mask);
+    sigaction(SIGPROF, &_action, NULL);
+
+    const char* _freq_env  = getenv("INSTRUMENT_SAMPLING_FREQUENCY");
+    const char* _clock_env = getenv("INSTRUMENT_SAMPLING_CLOCK");
+
+    inst_sampling_freq = (_freq_env) ? atof(_freq_env) : 0.0;
+    if(inst_sampling_freq <= 0.0)
+        inst_sampling_freq = INSTRUMENT_SAMPLING_FREQUENCY;
+
+    long _period = (long) (1.0e9 / inst_sampling_freq);  // nanoseconds
+    if(_period < 1000)
+        _period = 1000;
+
+    inst_sampling_stop();
+
+#if defined(__linux__)
+    if(_clock_env && strcmp(_clock_env, "realtime") == 0)
+    {
+        if(inst_sampling_timer_pid != getpid())
+        {
+            struct sigevent _event;
+            memset(&_event, 0, sizeof(_event));
+            _event.sigev_notify = SIGEV_SIGNAL;
+            _event.sigev_signo  = SIGPROF;
+            if(timer_create(CLOCK_MONOTONIC, &_event, &inst_sampling_timer) == 0)
+                inst_sampling_timer_pid = getpid();
+        }
+        if(inst_sampling_timer_pid == getpid())
+        {
+            struct itimerspec _spec;
+            _spec.it_interval.tv_sec  = _period / 1000000000L;
+            _spec.it_interval.tv_nsec = _period % 1000000000L;
+            _spec.it_value            = _spec.it_interval;
+            timer_settime(inst_sampling_timer, 0, &_spec, NULL);
+            return;
+        }
+    }
+#else
+    (void) _clock_env;
+#endif
+
+    struct itimerval _value;
+    _value.it_interval.tv_sec  = _period / 1000000000L;
+    _value.it_interval.tv_usec = (_period % 1000000000L) / 1000L;
+    _value.it_value            = _value.it_interval;
+    setitimer(ITIMER_PROF, &_value, NULL);
+}
+
+//--------------------------------------------------------------------------------------//
+
+typedef struct _inst_sampling_entry
+{
+    uintptr_t addr;
+    uint64_t  count;
+} inst_sampling_entry;
+
+static inline int
+inst_sampling_compare_addr(const void* lhs, const void* rhs)
+{
+    uintptr_t _lhs = *(const uintptr_t*) lhs;
+    uintptr_t _rhs = *(const uintptr_t*) rhs;
+    return (_lhs < _rhs) ? -1 : ((_lhs > _rhs) ? 1 : 0);
+}
+
+static inline int
+inst_sampling_compare_count(const void* lhs, const void* rhs)
+{
+    uint64_t _lhs = ((const inst_sampling_entry*) lhs)->count;
+    uint64_t _rhs = ((const inst_sampling_entry*) rhs)->count;
+    return (_lhs > _rhs) ? -1 : ((_lhs < _rhs) ? 1 : 0);
+}
+
+//--------------------------------------------------------------------------------------//
+/// stop sampling and report the functions with the most samples (offline, so it can
+/// allocate and resolve symbols). The samples are reset afterwards
+static inline void
+inst_sampling_finalize(void)
+{
+    inst_sampling_stop();
+
+    uint64_t _total = __atomic_exchange_n(&inst_sampling_count, 0, __ATOMIC_RELAXED);
+    uint64_t _n     = (_total < INSTRUMENT_SAMPLING_RING_SIZE)
+                      ? _total
+                      : (uint64_t) INSTRUMENT_SAMPLING_RING_SIZE;
+    if(_n == 0)
+        return;
+
+    // map every program counter to the start of its function
+    uintptr_t*           _func   = (uintptr_t*) malloc(_n * sizeof(uintptr_t));
+    inst_sampling_entry* _unique = (inst_sampling_entry*) malloc(_n * sizeof(*_unique));
+    if(!_func || !_unique)
+    {
+        free(_func);
+        free(_unique);
+        return;
+    }
+
+    for(uint64_t i = 0; i < _n; ++i)
+    {
+        Dl_info _info;
+        _func[i] = inst_sampling_ring[i];
+        if(dladdr((void*) inst_sampling_ring[i], &_info) && _info.dli_saddr)
+            _func[i] = (uintptr_t) _info.dli_saddr;
+    }
+
+    qsort(_func, _n, sizeof(uintptr_t), inst_sampling_compare_addr);
+
+    uint64_t _nunique = 0;
+    for(uint64_t i = 0; i < _n; ++i)
+    {
+        if(_nunique == 0 || _unique[_nunique - 1].addr != _func[i])
+        {
+            _unique[_nunique].addr  = _func[i];
+            _unique[_nunique].count = 0;
+            ++_nunique;
+        }
+        ++_unique[_nunique - 1].count;
+    }
+
+    qsort(_unique, _nunique, sizeof(*_unique), inst_sampling_compare_count);
+
+    printf("[sampling]> %" PRIu64 " samples at %.0f Hz (%" PRIu64 " kept)\n", _total,
+           inst_sampling_freq, _n);
+
+    for(uint64_t i = 0; i < _nunique && i < INSTRUMENT_SAMPLING_REPORT_SIZE; ++i)
+    {
+        Dl_info     _info;
+        const char* _name  = "???";
+        char*       _demangled = NULL;
+        if(dladdr((void*) _unique[i].addr, &_info) && _info.dli_sname)
+        {
+            _name = _info.dli_sname;
+#if defined(__cplusplus)
+            int _status = 0;
+            _demangled  = abi::__cxa_demangle(_name, NULL, NULL, &_status);
+            if(_status == 0 && _demangled)
+                _name = _demangled;
+#endif
+        }
+        printf("[sampling]> %8.3f%%  %10" PRIu64 "  %s\n",
+               100.0 * _unique[i].count / _n, _unique[i].count, _name);
+        free(_demangled);
+    }
+
+    free(_func);
+    free(_unique);
+}
+
+//--------------------------------------------------------------------------------------//
+
+#define INSTRUMENT_CONFIGURE() inst_sampling_configure();
+#define INSTRUMENT_CREATE(...)
+#define INSTRUMENT_START(...)
+#define INSTRUMENT_STOP(...)
+#define INSTRUMENT_SUSPEND() inst_sampling_stop();
+#define INSTRUMENT_FINALIZE() inst_sampling_finalize();
@@ -0,0 +1,210 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#    include <linux/perf_event.h>
+#    include <sys/syscall.h>
+#endif
+
+//--------------------------------------------------------------------------------------//
+/// peak resident set size of the process (bytes)
+inline int64_t
+peak_rss()
+{
+    struct rusage _usage;
+    if(getrusage(RUSAGE_SELF, &_usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return _usage.ru_maxrss;
+#else
+    return static_cast<int64_t>(_usage.ru_maxrss) * 1024;
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+/// current resident set size of the process (bytes), the peak if it is not available
+inline int64_t
+current_rss()
+{
+#if defined(__linux__)
+    FILE* _file = fopen("/proc/self/statm", "r");
+    if(_file)
+    {
+        long _size     = 0;
+        long _resident = 0;
+        int  _n        = fscanf(_file, "%ld %ld", &_size, &_resident);
+        fclose(_file);
+        if(_n == 2)
+            return static_cast<int64_t>(_resident) * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return peak_rss();
+}
+
+//--------------------------------------------------------------------------------------//
+/// voluntary (blocking, e.g. I/O) and involuntary (preempted) context switches of all
+/// the threads of the process
+inline std::pair<int64_t, int64_t>
+context_switches()
+{
+    struct rusage _usage;
+    if(getrusage(RUSAGE_SELF, &_usage) != 0)
+        return std::pair<int64_t, int64_t>(0, 0);
+    return std::pair<int64_t, int64_t>(_usage.ru_nvcsw, _usage.ru_nivcsw);
+}
+
+//--------------------------------------------------------------------------------------//
+/// hardware event counters of the calling thread (user space only). Uses perf_event on
+/// Linux; counters which cannot be opened (no PMU, perf_event_paranoid, containers or
+/// other platforms) are not available and read as -1
+class hw_counters
+{
+public:
+    enum event : int
+    {
+        branch_misses = 0,
+        branches,
+        itlb_misses,
+        instructions,
+        nevents
+    };
+
+    hw_counters()
+    {
+        for(int i = 0; i < nevents; ++i)
+            m_fd[i] = open_event(static_cast<event>(i));
+    }
+
+    ~hw_counters()
+    {
+        for(int i = 0; i < nevents; ++i)
+            if(m_fd[i] >= 0)
+                close(m_fd[i]);
+    }
+
+    hw_counters(const hw_counters&) = delete;
+    hw_counters& operator=(const hw_counters&) = delete;
+
+    static const char* name(event _event)
+    {
+        static const char* _names[] = { "branch_misses", "branches", "itlb_misses",
+                                        "instructions" };
+        return _names[_event];
+    }
+
+    bool available(event _event) const { return m_fd[_event] >= 0; }
+
+    int64_t navailable() const
+    {
+        int64_t _n = 0;
+        for(int i = 0; i < nevents; ++i)
+            _n += (m_fd[i] >= 0) ? 1 : 0;
+        return _n;
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+        for(int i = 0; i < nevents; ++i)
+        {
+            if(m_fd[i] < 0)
+                continue;
+            ioctl(m_fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop()
+    {
+#if defined(__linux__)
+        for(int i = 0; i < nevents; ++i)
+            if(m_fd[i] >= 0)
+                ioctl(m_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+#endif
+    }
+
+    int64_t read(event _event) const
+    {
+        uint64_t _value = 0;
+        if(m_fd[_event] < 0 ||
+           ::read(m_fd[_event], &_value, sizeof(_value)) != sizeof(_value))
+            return -1;
+        return static_cast<int64_t>(_value);
+    }
+
+private:
+    static int open_event(event _event)
+    {
+#if defined(__linux__)
+        struct perf_event_attr _attr;
+        memset(&_attr, 0, sizeof(_attr));
+        _attr.size           = sizeof(_attr);
+        _attr.disabled       = 1;
+        _attr.exclude_kernel = 1;
+        _attr.exclude_hv     = 1;
+        switch(_event)
+        {
+            case branch_misses:
+                _attr.type   = PERF_TYPE_HARDWARE;
+                _attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case branches:
+                _attr.type   = PERF_TYPE_HARDWARE;
+                _attr.config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
+                break;
+            case itlb_misses:
+                _attr.type   = PERF_TYPE_HW_CACHE;
+                _attr.config = PERF_COUNT_HW_CACHE_ITLB |
+                               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case instructions:
+                _attr.type   = PERF_TYPE_HARDWARE;
+                _attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            default: return -1;
+        }
+        long _fd = syscall(__NR_perf_event_open, &_attr, 0, -1, -1, 0);
+        return static_cast<int>(_fd);
+#else
+        (void) _event;
+        return -1;
+#endif
+    }
+
+    int m_fd[nevents];
+};
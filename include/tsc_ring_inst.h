@@ -0,0 +1,404 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+//
+// Reference submodule: the cheapest practical timer ("speed of light").
+//
+// INSTRUMENT_START/STOP read the time-stamp counter into a thread-local, preallocated,
+// cache-line aligned ring of events. The hot path has no locks, no allocation and no
+// hashing: one TLS load, one counter increment and two stores. The ring of a thread is
+// taken on first use (or by INSTRUMENT_CONFIGURE for the calling thread) from a free
+// list, or allocated and registered in a lock-free list, and goes back to the free list
+// when the thread exits. The number of rings (16 bytes per event, 1 MiB by default) is
+// bounded by the number of threads alive at once and the events of an exited thread stay
+// in its ring until the next owner overwrites them. INSTRUMENT_FINALIZE pairs the
+// start/stop events of the most recent INSTRUMENT_TSC_RING_SIZE events per ring offline
+// and reports the time per label. Rings are not synchronized: finalize after the
+// instrumented threads are done. INSTRUMENT_ENTER/EXIT (-finstrument-functions) record
+// the address of the function as the label. INSTRUMENT_QUERY_DEPTH scans the events
+// recorded by the calling thread.
+//
+// The label of INSTRUMENT_START/STOP is __FUNCTION__, not the macro argument, so every
+// region of a function is the same label. INSTRUMENT_START/STOP_LABEL record the given
+// label instead, which is why it must outlive INSTRUMENT_FINALIZE.
+//
+
+#pragma once
+
+#if !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+// number of events per thread (power of two), older events are overwritten
+#if !defined(INSTRUMENT_TSC_RING_SIZE)
+#    define INSTRUMENT_TSC_RING_SIZE (1 << 16)
+#endif
+
+#define INST_TSC_CACHE_LINE 64
+#define INST_TSC_STOP_BIT (UINT64_C(1) << 63)
+#define INST_TSC_ADDR_BIT (UINT64_C(1) << 62)
+#define INST_TSC_TIME_MASK (~(INST_TSC_STOP_BIT | INST_TSC_ADDR_BIT))
+
+// state is shared by every translation unit (and library) including this header
+#define INST_TSC_SHARED __attribute__((weak, visibility("default")))
+// the ring pointer uses the initial-exec TLS model (an offset from the thread pointer)
+// instead of calling __tls_get_addr. It is shared like the rest of the state, so the
+// INSTRUMENT_CONFIGURE of the python module preallocates the ring that the kernel
+// library records into
+#define INST_TSC_THREAD                                                                  \
+    __attribute__((weak, visibility("default"), tls_model("initial-exec")))
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+    //--------------------------------------------------------------------------------------//
+    /// start/stop event: time-stamp (high bit set for stop, next bit set if the label is
+    /// the address of a function) and the label
+    typedef struct _inst_tsc_event
+    {
+        uint64_t    tsc;
+        const char* label;
+    } inst_tsc_event;
+
+    //--------------------------------------------------------------------------------------//
+    /// per-thread ring, the counter is on its own cache line. begin is the counter when
+    /// the current thread took the ring
+    typedef struct _inst_tsc_buffer
+    {
+        uint64_t                 count __attribute__((aligned(INST_TSC_CACHE_LINE)));
+        struct _inst_tsc_buffer* next __attribute__((aligned(INST_TSC_CACHE_LINE)));
+        struct _inst_tsc_buffer* free_next;
+        uint64_t                 begin;
+        inst_tsc_event           events[INSTRUMENT_TSC_RING_SIZE]
+            __attribute__((aligned(INST_TSC_CACHE_LINE)));
+    } inst_tsc_buffer;
+
+    INST_TSC_THREAD __thread inst_tsc_buffer* inst_tsc_local;
+    INST_TSC_SHARED inst_tsc_buffer*          inst_tsc_registry;
+    INST_TSC_SHARED inst_tsc_buffer*          inst_tsc_free;
+    INST_TSC_SHARED unsigned char             inst_tsc_free_lock;
+    INST_TSC_SHARED pthread_key_t             inst_tsc_key;
+    INST_TSC_SHARED pthread_once_t            inst_tsc_key_once = PTHREAD_ONCE_INIT;
+    INST_TSC_SHARED uint64_t                  inst_tsc_calib_tsc;
+    INST_TSC_SHARED double                    inst_tsc_calib_time;
+
+#if defined(__cplusplus)
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+/// read the time-stamp counter (nanoseconds of the monotonic clock if there is none)
+static inline uint64_t
+inst_tsc_now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t _val;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(_val));
+    return _val;
+#else
+    struct timespec _ts;
+    clock_gettime(CLOCK_MONOTONIC, &_ts);
+    return (uint64_t) _ts.tv_sec * UINT64_C(1000000000) + (uint64_t) _ts.tv_nsec;
+#endif
+}
+
+//--------------------------------------------------------------------------------------//
+
+static inline double
+inst_tsc_wtime(void)
+{
+    struct timeval _now;
+    gettimeofday(&_now, NULL);
+    return (double) _now.tv_sec + 1.0e-6 * _now.tv_usec;
+}
+
+//--------------------------------------------------------------------------------------//
+/// the free list is only used when a thread starts or exits, a spin lock is enough
+static inline void
+inst_tsc_free_push(inst_tsc_buffer* _buf)
+{
+    while(__atomic_test_and_set(&inst_tsc_free_lock, __ATOMIC_ACQUIRE))
+    {
+    }
+    _buf->free_next = inst_tsc_free;
+    inst_tsc_free   = _buf;
+    __atomic_clear(&inst_tsc_free_lock, __ATOMIC_RELEASE);
+}
+
+//--------------------------------------------------------------------------------------//
+
+static inline inst_tsc_buffer*
+inst_tsc_free_pop(void)
+{
+    while(__atomic_test_and_set(&inst_tsc_free_lock, __ATOMIC_ACQUIRE))
+    {
+    }
+    inst_tsc_buffer* _buf = inst_tsc_free;
+    if(_buf)
+        inst_tsc_free = _buf->free_next;
+    __atomic_clear(&inst_tsc_free_lock, __ATOMIC_RELEASE);
+    return _buf;
+}
+
+//--------------------------------------------------------------------------------------//
+/// destructor of inst_tsc_key: the ring of an exiting thread goes back to the free list
+static inline void
+inst_tsc_thread_exit(void* _ptr)
+{
+    inst_tsc_local = NULL;
+    inst_tsc_free_push((inst_tsc_buffer*) _ptr);
+}
+
+//--------------------------------------------------------------------------------------//
+
+static inline void
+inst_tsc_key_init(void)
+{
+    pthread_key_create(&inst_tsc_key, &inst_tsc_thread_exit);
+}
+
+//--------------------------------------------------------------------------------------//
+/// take a ring from the free list (or allocate and register a new one) for the calling
+/// thread (cold path)
+static inline inst_tsc_buffer*
+inst_tsc_thread_init(void)
+{
+    if(inst_tsc_local)
+        return inst_tsc_local;
+
+    pthread_once(&inst_tsc_key_once, &inst_tsc_key_init);
+
+    inst_tsc_buffer* _buf = inst_tsc_free_pop();
+    if(_buf == NULL)
+    {
+        void* _ptr = NULL;
+        if(posix_memalign(&_ptr, INST_TSC_CACHE_LINE, sizeof(inst_tsc_buffer)) != 0)
+        {
+            fprintf(stderr, "[tsc_ring]> unable to allocate the event ring\n");
+            abort();
+        }
+
+        _buf        = (inst_tsc_buffer*) _ptr;
+        _buf->count = 0;
+        _buf->next  = __atomic_load_n(&inst_tsc_registry, __ATOMIC_RELAXED);
+        while(!__atomic_compare_exchange_n(&inst_tsc_registry, &_buf->next, _buf, 1,
+                                           __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+        }
+    }
+
+    _buf->begin = _buf->count;
+    pthread_setspecific(inst_tsc_key, _buf);
+    inst_tsc_local = _buf;
+    return _buf;
+}
+
+//--------------------------------------------------------------------------------------//
+/// hot path
+static inline void
+inst_tsc_record(const char* label, uint64_t stop)
+{
+    inst_tsc_buffer* _buf = inst_tsc_local;
+    if(__builtin_expect(_buf == NULL, 0))
+        _buf = inst_tsc_thread_init();
+    inst_tsc_event* _event = &_buf->events[_buf->count++ & (INSTRUMENT_TSC_RING_SIZE - 1)];
+    _event->label          = label;
+    _event->tsc            = inst_tsc_now() | stop;
+}
+
+//--------------------------------------------------------------------------------------//
+/// starts minus stops recorded by the calling thread, unknown once the ring has wrapped
+static inline int64_t
+inst_tsc_depth(void)
+{
+    inst_tsc_buffer* _buf = inst_tsc_local;
+    if(_buf == NULL)
+        return 0;
+    if(_buf->count - _buf->begin > INSTRUMENT_TSC_RING_SIZE)
+        return INT64_MIN;
+    int64_t _depth = 0;
+    for(uint64_t i = _buf->begin; i < _buf->count; ++i)
+    {
+        const inst_tsc_event* _event = &_buf->events[i & (INSTRUMENT_TSC_RING_SIZE - 1)];
+        _depth += (_event->tsc & INST_TSC_STOP_BIT) ? -1 : 1;
+    }
+    return _depth;
+}
+
+//--------------------------------------------------------------------------------------//
+
+static inline void
+inst_tsc_configure(void)
+{
+    inst_tsc_thread_init();
+    if(inst_tsc_calib_time == 0.0)
+    {
+        inst_tsc_calib_time = inst_tsc_wtime();
+        inst_tsc_calib_tsc  = inst_tsc_now();
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+typedef struct _inst_tsc_summary
+{
+    const char* label;
+    uint64_t    addr;
+    uint64_t    count;
+    uint64_t    ticks;
+} inst_tsc_summary;
+
+//--------------------------------------------------------------------------------------//
+/// offline aggregation: pair start/stop events with a stack per thread and accumulate
+/// the ticks per label (labels are compared by content). Rings are reset afterwards
+static inline void
+inst_tsc_finalize(void)
+{
+    double   _elapsed = inst_tsc_wtime() - inst_tsc_calib_time;
+    uint64_t _ticks   = inst_tsc_now() - inst_tsc_calib_tsc;
+    double   _freq    = (inst_tsc_calib_time > 0.0 && _elapsed > 0.0)
+                       ? (double) _ticks / _elapsed
+                       : 0.0;
+
+    inst_tsc_summary* _summary  = NULL;
+    uint64_t          _nsummary = 0;
+    uint64_t          _nevents  = 0;
+    uint64_t          _nkept    = 0;
+    uint64_t          _nrings   = 0;
+    inst_tsc_event*   _stack    = NULL;
+    uint64_t          _capacity = 0;
+
+    for(inst_tsc_buffer* _buf = __atomic_load_n(&inst_tsc_registry, __ATOMIC_ACQUIRE);
+        _buf; _buf = _buf->next)
+    {
+        uint64_t _count = _buf->count;
+        uint64_t _n     = (_count < INSTRUMENT_TSC_RING_SIZE)
+                          ? _count
+                          : (uint64_t) INSTRUMENT_TSC_RING_SIZE;
+        uint64_t _depth = 0;
+
+        _nevents += _count;
+        _nkept += _n;
+        ++_nrings;
+
+        for(uint64_t i = _count - _n; i < _count; ++i)
+        {
+            const inst_tsc_event* _event =
+                &_buf->events[i & (INSTRUMENT_TSC_RING_SIZE - 1)];
+
+            if((_event->tsc & INST_TSC_STOP_BIT) == 0)
+            {
+                if(_depth == _capacity)
+                {
+                    _capacity = (_capacity == 0) ? 64 : 2 * _capacity;
+                    _stack    = (inst_tsc_event*) realloc(_stack,
+                                                       _capacity * sizeof(inst_tsc_event));
+                }
+                _stack[_depth++] = *_event;
+                continue;
+            }
+
+            // stop without a start in the kept window
+            if(_depth == 0)
+                continue;
+
+            const inst_tsc_event* _start = &_stack[--_depth];
+            uint64_t _delta =
+                (_event->tsc & INST_TSC_TIME_MASK) - (_start->tsc & INST_TSC_TIME_MASK);
+            uint64_t _addr = _start->tsc & INST_TSC_ADDR_BIT;
+
+            uint64_t j = 0;
+            for(; j < _nsummary; ++j)
+            {
+                if(_summary[j].label == _start->label ||
+                   (!_addr && !_summary[j].addr &&
+                    strcmp(_summary[j].label, _start->label) == 0))
+                    break;
+            }
+            if(j == _nsummary)
+            {
+                _summary = (inst_tsc_summary*) realloc(
+                    _summary, (_nsummary + 1) * sizeof(inst_tsc_summary));
+                _summary[j].label = _start->label;
+                _summary[j].addr  = _addr;
+                _summary[j].count = 0;
+                _summary[j].ticks = 0;
+                ++_nsummary;
+            }
+            _summary[j].count += 1;
+            _summary[j].ticks += _delta;
+        }
+
+        _buf->count = 0;
+        _buf->begin = 0;
+    }
+
+    if(_nevents > 0)
+    {
+        printf("[tsc_ring]> %" PRIu64 " events in %" PRIu64 " rings (%" PRIu64
+               " kept), %.3e ticks/sec\n",
+               _nevents, _nrings, _nkept, _freq);
+        for(uint64_t j = 0; j < _nsummary; ++j)
+        {
+            double _sec = (_freq > 0.0) ? _summary[j].ticks / _freq : 0.0;
+            char   _name[32];
+            if(_summary[j].addr)
+                snprintf(_name, sizeof(_name), "%p", (const void*) _summary[j].label);
+            printf("[tsc_ring]> %-24s %12" PRIu64 " calls %16" PRIu64
+                   " ticks %12.6f sec\n",
+                   (_summary[j].addr) ? _name : _summary[j].label, _summary[j].count,
+                   _summary[j].ticks, _sec);
+        }
+    }
+
+    free(_stack);
+    free(_summary);
+}
+
+//--------------------------------------------------------------------------------------//
+
+#define INSTRUMENT_CONFIGURE() inst_tsc_configure();
+#define INSTRUMENT_CREATE(...)
+#define INSTRUMENT_START(...) inst_tsc_record(__FUNCTION__, 0);
+#define INSTRUMENT_STOP(...) inst_tsc_record(__FUNCTION__, INST_TSC_STOP_BIT);
+#define INSTRUMENT_CREATE_LABEL(label)
+#define INSTRUMENT_START_LABEL(label) inst_tsc_record((label), 0);
+#define INSTRUMENT_STOP_LABEL(label) inst_tsc_record((label), INST_TSC_STOP_BIT);
+#define INSTRUMENT_FINALIZE() inst_tsc_finalize();
+#define INSTRUMENT_QUERY_DEPTH() inst_tsc_depth()
+#define INSTRUMENT_ENTER(fn) inst_tsc_record((const char*) (fn), INST_TSC_ADDR_BIT);
+#define INSTRUMENT_EXIT(fn)                                                              \
+    inst_tsc_record((const char*) (fn), INST_TSC_ADDR_BIT | INST_TSC_STOP_BIT);
@@ -0,0 +1,179 @@
+#!/usr/bin/env python
+
+# MIT License
+#
+# Copyright (c) 2019 The Regents of the University of California
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""
+Cost of instrumented regions driven from python, i.e. including the crossing of the
+language boundary:
+
+    python -m instrument_benchmark.boundary [-n NREGIONS] [-w WORK] [-i N] [SUBMODULE ...]
+
+Every region is a native function wrapping `work` iterations. For each submodule the
+following is reported (seconds per region, median of the iterations):
+
+    per-call        : python loop calling region() once per region
+    per-call (none) : python loop calling the uninstrumented region_none()
+    batched         : native loop over the same regions (region_batch())
+    batched (none)  : native loop without instrumentation
+    boundary        : per-call (none) - batched (none), i.e. the crossing + python loop
+    overhead        : per-call - per-call (none), the tool when called from python
+    overhead (batch): batched - batched (none), the tool when called natively
+    total           : per-call - batched (none), the tool and the boundary together
+"""
+
+from __future__ import absolute_import
+from __future__ import print_function
+import os
+import time
+import argparse
+import importlib
+
+__author__ = "Jonathan Madsen"
+__copyright__ = "Copyright 2019, The Regents of the University of California"
+__credits__ = ["Jonathan Madsen"]
+__license__ = "MIT"
+__maintainer__ = "Jonathan Madsen"
+__email__ = "jrmadsen@lbl.gov"
+
+# package directory
+this_path = os.path.abspath(os.path.dirname(__file__))
+package = os.path.basename(this_path)
+
+
+def submodules():
+    """Submodules of the package providing the per-region functions"""
+    return __import__(package).submodules
+
+
+# the native batches sum modulo 2^64
+_mask = 0xFFFFFFFFFFFFFFFF
+
+
+def _per_call(func, nregions, work):
+    """Time a python loop calling func once per region"""
+    ans = 0
+    t0 = time.perf_counter()
+    for i in range(nregions):
+        ans += func(i, work)
+    return time.perf_counter() - t0, ans & _mask
+
+
+def _batched(func, nregions, work, instrument):
+    t0 = time.perf_counter()
+    ans = func(nregions, work, instrument)
+    return time.perf_counter() - t0, ans & _mask
+
+
+def _median(values):
+    values = sorted(values)
+    n = len(values)
+    if n == 0:
+        return float("nan")
+    return values[n // 2] if n % 2 == 1 else 0.5 * (values[n // 2 - 1] + values[n // 2])
+
+
+def measure(name, nregions=100000, work=100, nitr=5):
+    """Per-region cost of the instrumentation of a submodule called from python
+    (per-call) and natively (batched). Returns None if the submodule does not provide
+    the per-region functions (C-only submodules)"""
+    mod = importlib.import_module("{}.{}".format(package, name))
+    if not hasattr(mod, "region"):
+        return None
+
+    modes = {"per_call_none": lambda: _per_call(mod.region_none, nregions, work),
+             "per_call": lambda: _per_call(mod.region, nregions, work),
+             "batched_none": lambda: _batched(mod.region_batch, nregions, work, False),
+             "batched": lambda: _batched(mod.region_batch, nregions, work, True)}
+
+    data = {}
+    answers = {}
+    mod.configure()
+    try:
+        # the first iteration is a warm-up
+        for i in range(nitr + 1):
+            for key, func in modes.items():
+                elapsed, ans = func()
+                answers.setdefault(key, ans)
+                if answers[key] != ans:
+                    raise RuntimeError("{}: answer of {} changed: {} vs. {}".format(
+                        name, key, answers[key], ans))
+                if i > 0:
+                    data.setdefault(key, []).append(elapsed / nregions)
+    finally:
+        mod.suspend()
+
+    # we need to use these values so they don't get optimized away
+    if len(set(answers.values())) != 1:
+        raise RuntimeError("{}: answers w/ and w/o instrumentation differ: {}".format(
+            name, answers))
+
+    ret = {key: _median(values) for key, values in data.items()}
+    ret["boundary"] = ret["per_call_none"] - ret["batched_none"]
+    ret["overhead"] = ret["per_call"] - ret["per_call_none"]
+    ret["overhead_batched"] = ret["batched"] - ret["batched_none"]
+    ret["total"] = ret["per_call"] - ret["batched_none"]
+    ret["submodule"] = name
+    ret["nregions"] = nregions
+    ret["work"] = work
+    return ret
+
+
+def report(results, output=print):
+    """Prints a table of the results of measure()"""
+    cols = [("per_call", "per-call"), ("per_call_none", "per-call none"),
+            ("batched", "batched"), ("batched_none", "batched none"),
+            ("boundary", "boundary"), ("overhead", "overhead"),
+            ("overhead_batched", "overhead bat."), ("total", "total")]
+    output("{:>20} {}".format(
+        "submodule", " ".join(["{:>13}".format(c[1]) for c in cols])))
+    for entry in results:
+        if entry is None:
+            continue
+        output("{:>20} {}".format(
+            entry["submodule"],
+            " ".join(["{:13.3e}".format(entry[c[0]]) for c in cols])))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Measure the per-region cost of instrumentation driven from python")
+    parser.add_argument("submodules", type=str, nargs='*', default=[],
+                        help="Submodules to measure (default: all)")
+    parser.add_argument("-n", "--nregions", type=int, default=100000,
+                        help="Number of regions per iteration")
+    parser.add_argument("-w", "--work", type=int, default=100,
+                        help="Work (iterations) per region")
+    parser.add_argument("-i", "--iterations", type=int, default=5,
+                        help="Number of iterations (the median is reported)")
+    args = parser.parse_args(argv)
+
+    names = args.submodules if len(args.submodules) > 0 else sorted(submodules())
+    results = [measure(name, args.nregions, args.work, args.iterations)
+               for name in names]
+    report(results)
+    return results
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,140 @@
+#!/usr/bin/env python
+
+# MIT License
+#
+# Copyright (c) 2019 The Regents of the University of California
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""
+Compile-time and code-size cost of each submodule, recorded by the compiler launcher
+(cmake/Scripts/compile-launcher.py) while building the submodule libraries and compared
+against the reference submodule:
+
+    python -m instrument_benchmark.compile_report [-b BASELINE] [-o FILE]
+"""
+
+from __future__ import absolute_import
+from __future__ import print_function
+import os
+import json
+import glob
+import argparse
+
+__author__ = "Jonathan Madsen"
+__copyright__ = "Copyright 2019, The Regents of the University of California"
+__credits__ = ["Jonathan Madsen"]
+__license__ = "MIT"
+__maintainer__ = "Jonathan Madsen"
+__email__ = "jrmadsen@lbl.gov"
+
+# directory the launcher writes to
+report_dir = "@INST_COMPILE_REPORT_DIR@"
+
+# recorded quantities
+fields = ["compile_time", "object_size", "text_size", "symbols"]
+
+
+def load(path=report_dir):
+    """Returns { submodule : { source : entry } } where source is the name of the
+    kernel source without the submodule suffix (e.g. matmul.cpp)"""
+    data = {}
+    if not os.path.isdir(path):
+        return data
+    for module in sorted(os.listdir(path)):
+        for fname in sorted(glob.glob(os.path.join(path, module, "*.json"))):
+            with open(fname, "r") as f:
+                entry = json.load(f)
+            src = os.path.basename(entry["source"])
+            base, ext = os.path.splitext(src)
+            if base.endswith("_{}".format(module)):
+                src = "{}{}".format(base[:-(len(module) + 1)], ext)
+            data.setdefault(module, {})[src] = entry
+    return data
+
+
+def compare(data, baseline="baseline"):
+    """Adds the difference w.r.t. the same source of the baseline submodule to each entry
+    (e.g. 'compile_time_delta') and a 'total' entry per submodule"""
+    for module, sources in data.items():
+        sources.pop("total", None)
+        sources["total"] = {key: sum([e.get(key, 0) for e in sources.values()])
+                            for key in fields}
+    ref = data.get(baseline, {})
+    for module, sources in data.items():
+        for src, entry in sources.items():
+            for key in fields:
+                if src in ref and key in entry and key in ref[src]:
+                    entry["{}_delta".format(key)] = entry[key] - ref[src][key]
+    return data
+
+
+def report(data, baseline="baseline", output=print):
+    """Prints a table of the results of compare()"""
+    output("{:>24} {:>16} {:>12} {:>12} {:>12} {:>10} {:>12} {:>12} {:>12} {:>10}".format(
+        "submodule", "source", "time (sec)", "object", ".text", "symbols",
+        "d(time)", "d(object)", "d(.text)", "d(symbols)"))
+    for module in sorted(data.keys()):
+        sources = data[module]
+        for src in sorted(sources.keys(), key=lambda x: (x == "total", x)):
+            entry = sources[src]
+            deltas = [entry.get("{}_delta".format(key)) for key in fields]
+            output("{:>24} {:>16} {:12.3f} {:>12} {:>12} {:>10} {} {} {} {}".format(
+                module, src, entry.get("compile_time", 0.0),
+                entry.get("object_size", 0), entry.get("text_size", 0),
+                entry.get("symbols", 0),
+                "{:12.3f}".format(deltas[0]) if deltas[0] is not None else "{:>12}".format("-"),
+                "{:>12}".format(deltas[1] if deltas[1] is not None else "-"),
+                "{:>12}".format(deltas[2] if deltas[2] is not None else "-"),
+                "{:>10}".format(deltas[3] if deltas[3] is not None else "-")))
+    if baseline not in data:
+        output("\n(no '{}' submodule recorded, differences not available)".format(baseline))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Compile-time and code-size report of the submodules")
+    parser.add_argument("-d", "--directory", type=str, default=report_dir,
+                        help="Directory written by the compiler launcher")
+    parser.add_argument("-b", "--baseline", type=str, default="baseline",
+                        help="Compute differences w.r.t. this submodule")
+    parser.add_argument("-o", "--output", type=str, default=None,
+                        help="Also write the report to this file (and a .json)")
+    args = parser.parse_args(argv)
+
+    data = compare(load(args.directory), args.baseline)
+    lines = []
+
+    def _output(message):
+        print(message)
+        lines.append(message)
+
+    report(data, args.baseline, _output)
+
+    if args.output is not None:
+        with open(args.output, "w") as f:
+            f.write("\n".join(lines) + "\n")
+        with open("{}.json".format(os.path.splitext(args.output)[0]), "w") as f:
+            json.dump(data, f, indent=2, sort_keys=True)
+    return data
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,182 @@
+#!/usr/bin/env python
+
+# MIT License
+#
+# Copyright (c) 2019 The Regents of the University of California
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""
+Lifecycle cost of the submodules.
+
+Every entry is measured in a fresh interpreter (not a fork of the current one) so the
+tool has not been configured and no other test has run in that process:
+
+    python -m instrument_benchmark.lifecycle [-r NREGIONS ...] [-o DIR] [SUBMODULE ...]
+
+For each number of regions the following is reported:
+
+    configure       : INSTRUMENT_CONFIGURE()
+    first region    : the first create/start/stop
+    regions         : the remaining nregions - 1 regions
+    finalize        : INSTRUMENT_FINALIZE()
+    exit            : from the return of finalize until the process has been reaped,
+                      i.e. the exit handlers and static destructors of the tool
+    files, bytes    : growth of the output directory of the tool (e.g.
+                      TIMEMORY_OUTPUT_PATH)
+"""
+
+from __future__ import absolute_import
+from __future__ import print_function
+import os
+import sys
+import json
+import time
+import argparse
+import tempfile
+import subprocess
+
+__author__ = "Jonathan Madsen"
+__copyright__ = "Copyright 2019, The Regents of the University of California"
+__credits__ = ["Jonathan Madsen"]
+__license__ = "MIT"
+__maintainer__ = "Jonathan Madsen"
+__email__ = "jrmadsen@lbl.gov"
+
+# package directory and the directory containing it
+this_path = os.path.abspath(os.path.dirname(__file__))
+root_path = os.path.dirname(this_path)
+package = os.path.basename(this_path)
+
+# executed in the fresh interpreter:
+#   <root> <package> <module> <bindings> <nregions> <path>
+_probe = """
+import sys, importlib
+
+root, pkg, name, bindings, nregions, path = sys.argv[1:7]
+sys.path.insert(0, root)
+
+importlib.import_module(pkg)
+if bindings and bindings != name:
+    importlib.import_module("{}.{}".format(pkg, bindings))
+mod = importlib.import_module("{}.{}".format(pkg, name))
+
+# writes the timings to path and exits the process from the library
+mod.lifecycle_probe(int(nregions), path)
+"""
+
+
+def submodules():
+    """Submodules of the package, without importing any of them"""
+    return __import__(package).submodules
+
+
+def _command(name, nregions, path):
+    pkg = __import__(package)
+    bindings = pkg.bindings_submodule if pkg.bindings_submodule in pkg.submodules else ""
+    return [sys.executable, "-c", _probe, root_path, package, name, bindings,
+            str(nregions), path]
+
+
+def _usage(path):
+    """Total size (bytes) and number of regular files under path. A path that does
+    not exist is empty"""
+    size, count = 0, 0
+    if not path or not os.path.exists(path):
+        return size, count
+    if os.path.isfile(path):
+        return os.lstat(path).st_size, 1
+    for root, dirs, files in os.walk(path):
+        for f in files:
+            _f = os.path.join(root, f)
+            if os.path.isfile(_f) and not os.path.islink(_f):
+                size += os.lstat(_f).st_size
+                count += 1
+    return size, count
+
+
+def _run(name, nregions, output_dir):
+    """Runs the probe in a fresh interpreter and returns the measurements"""
+    fd, path = tempfile.mkstemp(prefix="lifecycle-", suffix=".json")
+    os.close(fd)
+    try:
+        usage = _usage(output_dir)
+        proc = subprocess.Popen(_command(name, nregions, path))
+        proc.wait()
+        # same clock as wtime() (CLOCK_MONOTONIC)
+        reaped = time.monotonic()
+        final = _usage(output_dir)
+        if proc.returncode != 0:
+            raise RuntimeError("lifecycle probe of '{}' failed with exit code {}".format(
+                name, proc.returncode))
+        with open(path) as f:
+            ret = json.load(f)
+    finally:
+        os.remove(path)
+
+    ret["exit"] = reaped - ret.pop("exit_begin")
+    ret["bytes_written"] = final[0] - usage[0]
+    ret["files_written"] = final[1] - usage[1]
+    return ret
+
+
+def measure(name, nregions=None, output_dir=""):
+    """Lifecycle costs of a submodule for each number of regions
+    (default: 1, 10, 100, 1000 and 10000)"""
+    if nregions is None:
+        nregions = [1, 10, 100, 1000, 10000]
+    return [_run(name, n, output_dir) for n in nregions]
+
+
+def report(name, results, output=print):
+    """Prints a table of the results of measure()"""
+    output("\n[CXX]> LIFECYCLE_{}:\n".format(name.upper()))
+    output("\t{:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>12}".format(
+        "regions", "configure", "first", "finalize", "exit", "files", "bytes"))
+    for entry in results:
+        output("\t{:>10} {:10.3e} {:10.3e} {:10.3e} {:10.3e} {:>10} {:>12}".format(
+            entry["nregions"], entry["configure"], entry["first_region"],
+            entry["finalize"], entry["exit"], entry["files_written"],
+            entry["bytes_written"]))
+    output("")
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Measure the lifecycle cost of each submodule in a fresh process")
+    parser.add_argument("submodules", type=str, nargs='*', default=[],
+                        help="Submodules to measure (default: all)")
+    parser.add_argument("-r", "--regions", type=int, nargs='*',
+                        default=[1, 10, 100, 1000, 10000],
+                        help="Number of distinct regions per process")
+    parser.add_argument("-o", "--output-dir", type=str, default="",
+                        help="Output directory of the tool")
+    args = parser.parse_args(argv)
+
+    names = args.submodules if len(args.submodules) > 0 else sorted(submodules())
+    results = {}
+    for name in names:
+        results[name] = measure(name, args.regions, args.output_dir)
+        report(name, results[name])
+    return results
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,237 @@
+#!/usr/bin/env python
+
+# MIT License
+#
+# Copyright (c) 2019 The Regents of the University of California
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""
+Start-up cost of the submodules.
+
+Every measurement is made in a fresh interpreter so that nothing is already mapped:
+
+    python -m instrument_benchmark.startup [-n REPEAT] [SUBMODULE ...]
+
+For each submodule the following is reported (median of the repetitions):
+
+    dlopen (lazy)   : dlopen(RTLD_LAZY) of libpy<module> and its tool dependencies
+    dlopen (now)    : dlopen(RTLD_NOW), i.e. including binding of every PLT entry
+    load            : mapping of the objects (from the dynamic linker debug output)
+    relocation      : relocation processing (from the dynamic linker debug output)
+    static init     : constructors / static initializers (from the dynamic linker debug output)
+    pyinit          : python import of the already loaded library (PyInit_<module>)
+    rss (dlopen)    : increase in resident memory from the dlopen
+    rss (import)    : increase in resident memory from the python import
+"""
+
+from __future__ import absolute_import
+from __future__ import print_function
+import os
+import sys
+import json
+import glob
+import time
+import argparse
+import subprocess
+
+__author__ = "Jonathan Madsen"
+__copyright__ = "Copyright 2019, The Regents of the University of California"
+__credits__ = ["Jonathan Madsen"]
+__license__ = "MIT"
+__maintainer__ = "Jonathan Madsen"
+__email__ = "jrmadsen@lbl.gov"
+
+# package directory and the directory containing it
+this_path = os.path.abspath(os.path.dirname(__file__))
+root_path = os.path.dirname(this_path)
+package = os.path.basename(this_path)
+
+# executed in the fresh interpreter: <root> <package> <module> <bindings> <library> <mode>
+_probe = """
+import os, sys, time, json, ctypes, importlib
+
+root, pkg, name, bindings, path, mode = sys.argv[1:7]
+sys.path.insert(0, root)
+
+
+def rss():
+    try:
+        with open("/proc/self/statm") as f:
+            return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except (IOError, OSError):
+        import resource
+        return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss * 1024
+
+
+# the package is lazy so only the shared bindings are loaded before the measurement
+importlib.import_module(pkg)
+if bindings and bindings != name:
+    importlib.import_module("{}.{}".format(pkg, bindings))
+
+flags = (os.RTLD_NOW if mode == "now" else os.RTLD_LAZY) | os.RTLD_LOCAL
+r0 = rss()
+t0 = time.perf_counter()
+ctypes.CDLL(path, mode=flags)
+t1 = time.perf_counter()
+r1 = rss()
+ret = {"dlopen": t1 - t0, "rss_dlopen": r1 - r0}
+
+# python reuses the handle so this is only the import machinery + PyInit
+if mode == "now":
+    t0 = time.perf_counter()
+    importlib.import_module("{}.{}".format(pkg, name))
+    t1 = time.perf_counter()
+    ret["pyinit"] = t1 - t0
+    ret["rss_import"] = rss() - r1
+
+sys.stdout.write(json.dumps(ret))
+"""
+
+
+def submodules():
+    """Submodules of the package, without importing any of them"""
+    return __import__(package).submodules
+
+
+def library_path(name):
+    """Path to the python library of a submodule"""
+    libs = glob.glob(os.path.join(this_path, name, "libpy{}*".format(name)))
+    if len(libs) == 0:
+        raise RuntimeError("No python library found for submodule '{}'".format(name))
+    return libs[0]
+
+
+def _command(name, mode):
+    pkg = __import__(package)
+    bindings = pkg.bindings_submodule if pkg.bindings_submodule in pkg.submodules else ""
+    return [sys.executable, "-c", _probe, root_path, package, name, bindings,
+            library_path(name), mode]
+
+
+def _run(name, mode):
+    """Runs the probe in a fresh interpreter and returns the measurements"""
+    proc = subprocess.Popen(_command(name, mode), stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE)
+    out, err = proc.communicate()
+    if proc.returncode != 0:
+        raise RuntimeError("startup probe of '{}' failed:\n{}".format(
+            name, err.decode("utf-8", "replace")))
+    return json.loads(out.decode("utf-8"))
+
+
+def _trace(name):
+    """Splits the dlopen into load, relocation and static init by time-stamping the
+    dynamic linker debug output (LD_DEBUG=files,reloc) as it is written by the probe.
+    The resolution is limited by the pipe (tens of microseconds) so these are only
+    meaningful for the larger tool libraries"""
+    env = dict(os.environ)
+    env["LD_DEBUG"] = "files,reloc"
+    env.pop("LD_DEBUG_OUTPUT", None)
+
+    lib = os.path.basename(library_path(name))
+    stamps = {}
+    proc = subprocess.Popen(_command(name, "now"), stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE, env=env)
+    for line in iter(proc.stderr.readline, b""):
+        now = time.perf_counter()
+        line = line.decode("utf-8", "replace")
+        if "begin" not in stamps:
+            if lib in line and "dynamically loaded by" in line:
+                stamps["begin"] = now
+        elif "relocation processing:" in line:
+            stamps.setdefault("relocation", now)
+        elif "calling init:" in line:
+            stamps.setdefault("init", now)
+        elif "opening file=" in line and lib in line:
+            stamps.setdefault("end", now)
+    proc.communicate()
+
+    if proc.returncode != 0 or len(stamps) != 4:
+        return {}
+    return {"load": stamps["relocation"] - stamps["begin"],
+            "relocation": stamps["init"] - stamps["relocation"],
+            "static_init": stamps["end"] - stamps["init"]}
+
+
+def _median(values):
+    values = sorted(values)
+    n = len(values)
+    if n == 0:
+        return float("nan")
+    return values[n // 2] if n % 2 == 1 else 0.5 * (values[n // 2 - 1] + values[n // 2])
+
+
+def measure(name, repeat=5, trace=True):
+    """Median start-up costs of a submodule over 'repeat' fresh processes"""
+    data = {}
+    for _ in range(repeat):
+        lazy = _run(name, "lazy")
+        now = _run(name, "now")
+        entry = {"dlopen_lazy": lazy["dlopen"],
+                 "dlopen_now": now["dlopen"],
+                 "bind_now": now["dlopen"] - lazy["dlopen"],
+                 "pyinit": now["pyinit"],
+                 "rss_dlopen": now["rss_dlopen"],
+                 "rss_import": now["rss_import"]}
+        if trace:
+            entry.update(_trace(name))
+        for key, value in entry.items():
+            data.setdefault(key, []).append(value)
+    ret = {key: _median(values) for key, values in data.items()}
+    ret["submodule"] = name
+    ret["repeat"] = repeat
+    return ret
+
+
+def report(results, output=print):
+    """Prints a table of the results of measure()"""
+    cols = [("dlopen_lazy", "dlopen lazy"), ("dlopen_now", "dlopen now"),
+            ("load", "load"), ("relocation", "relocation"),
+            ("static_init", "static init"), ("pyinit", "pyinit")]
+    output("{:>20} {} {:>12} {:>12}".format(
+        "submodule", " ".join(["{:>12}".format(c[1]) for c in cols]),
+        "rss dlopen", "rss import"))
+    for entry in results:
+        output("{:>20} {} {:>12} {:>12}".format(
+            entry["submodule"],
+            " ".join(["{:12.3e}".format(entry.get(c[0], float("nan"))) for c in cols]),
+            int(entry["rss_dlopen"]), int(entry["rss_import"])))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Measure the start-up cost of each submodule in a fresh process")
+    parser.add_argument("submodules", type=str, nargs='*', default=[],
+                        help="Submodules to measure (default: all)")
+    parser.add_argument("-n", "--repeat", type=int, default=5,
+                        help="Number of fresh processes per submodule")
+    parser.add_argument("--no-trace", action="store_true",
+                        help="Do not split the dlopen using the dynamic linker output")
+    args = parser.parse_args(argv)
+
+    names = args.submodules if len(args.submodules) > 0 else sorted(submodules())
+    results = [measure(name, args.repeat, not args.no_trace) for name in names]
+    report(results)
+    return results
+
+
+if __name__ == "__main__":
+    main()
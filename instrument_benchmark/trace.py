@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+
+# MIT License
+#
+# Copyright (c) 2019 The Regents of the University of California
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+"""
+Traces for the trace-replay kernel (trace_replay in every submodule).
+
+A trace is a sequence of (thread, label, event, work_ns) records where event is
+"start" or "stop" and work_ns is the duration (nanoseconds) of the work following the
+event. The CSV form has one "thread,label,event,work_ns" record per line. The binary
+form is memory-mapped by the kernel:
+
+    python -m instrument_benchmark.trace input.csv output.trace
+"""
+
+from __future__ import absolute_import
+from __future__ import print_function
+import sys
+import struct
+import argparse
+
+__author__ = "Jonathan Madsen"
+__copyright__ = "Copyright 2019, The Regents of the University of California"
+__credits__ = ["Jonathan Madsen"]
+__license__ = "MIT"
+__maintainer__ = "Jonathan Madsen"
+__email__ = "jrmadsen@lbl.gov"
+
+# must match trace_header and trace_event in source/trace_replay.cpp (native byte order)
+MAGIC = b"INSTTRC1"
+VERSION = 1
+HEADER = struct.Struct("=8sQQQQ")
+EVENT = struct.Struct("=IIIIQ")
+
+
+def read_csv(path):
+    """Returns the list of (thread, label, event, work_ns) records of a CSV trace"""
+    records = []
+    with open(path, "r") as f:
+        for lineno, line in enumerate(f):
+            line = line.strip()
+            if len(line) == 0 or line.startswith("#"):
+                continue
+            fields = [entry.strip() for entry in line.split(",")]
+            if lineno == 0 and fields[0] == "thread":
+                continue
+            if len(fields) != 4 or fields[2] not in ("start", "stop"):
+                raise ValueError("invalid record at {}:{}".format(path, lineno + 1))
+            records.append((int(fields[0]), fields[1], fields[2], int(fields[3])))
+    return records
+
+
+def write(path, records):
+    """Writes (thread, label, event, work_ns) records as a binary trace"""
+    labels = {}
+    for _, label, _, _ in records:
+        labels.setdefault(label, len(labels))
+
+    table = b"".join([label.encode("utf-8") + b"\0"
+                      for label, _ in sorted(labels.items(), key=lambda x: x[1])])
+    offset = HEADER.size + len(records) * EVENT.size
+
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, len(records), len(labels), offset))
+        for thread, label, event, work in records:
+            f.write(EVENT.pack(thread, labels[label], 1 if event == "stop" else 0, 0,
+                               work))
+        f.write(table)
+
+
+def convert(csv_path, out_path):
+    """Converts a CSV trace to the binary form"""
+    records = read_csv(csv_path)
+    write(out_path, records)
+    return len(records)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Convert a CSV region trace to the binary trace-replay format")
+    parser.add_argument("input", type=str, help="CSV trace")
+    parser.add_argument("output", type=str, help="Binary trace")
+    args = parser.parse_args(argv)
+
+    nrecords = convert(args.input, args.output)
+    print("Wrote {} records to '{}'".format(nrecords, args.output))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,92 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+
+#include <cstdint>
+
+//======================================================================================//
+// small computation wrapped by a region, the result depends on the label so repeated
+// calls are not folded
+
+static inline int64_t
+boundary_work(int64_t label, int64_t work)
+{
+    return static_cast<int64_t>(busy_work(label, work) >> 1);
+}
+
+//======================================================================================//
+
+int64_t
+cxx_boundary_region(int64_t label, int64_t work)
+{
+    INSTRUMENT_CREATE(label);
+    INSTRUMENT_START(label);
+    int64_t ret = boundary_work(label, work);
+    INSTRUMENT_STOP(label);
+    return ret;
+}
+
+//======================================================================================//
+
+int64_t
+cxx_boundary_region_none(int64_t label, int64_t work)
+{
+    return boundary_work(label, work);
+}
+
+//======================================================================================//
+// the same regions as calling cxx_boundary_region with labels 0 ... nregions - 1. The
+// sum wraps around (unsigned) instead of overflowing
+
+uint64_t
+cxx_boundary_batch(int64_t nregions, int64_t work)
+{
+    uint64_t ret = 0;
+    for(int64_t i = 0; i < nregions; ++i)
+        ret += static_cast<uint64_t>(cxx_boundary_region(i, work));
+    return ret;
+}
+
+//======================================================================================//
+
+uint64_t
+cxx_boundary_batch_none(int64_t nregions, int64_t work)
+{
+    uint64_t ret = 0;
+    for(int64_t i = 0; i < nregions; ++i)
+        ret += static_cast<uint64_t>(cxx_boundary_region_none(i, work));
+    return ret;
+}
+
+//======================================================================================//
@@ -0,0 +1,339 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+// how the labels of the regions are shared between the threads
+enum class sharing : int
+{
+    shared = 0,  // every thread uses the same label
+    priv,        // every thread uses its own label
+    mixed        // a fraction of the regions of every thread use the shared label
+};
+
+struct contention_config
+{
+    int64_t nthreads;
+    int64_t nregions;
+    int64_t work;
+    double  overlap;  // fraction of the regions using the shared label when mixed
+    // label of every index returned by contention_label
+    std::vector<const char*> labels;
+};
+
+// sums over the threads and entries of one launch
+struct contention_totals
+{
+    double elapsed    = 0.0;  // time spent in the regions by every thread
+    double throughput = 0.0;  // regions per second of every thread
+};
+
+// reusable barrier, the threads yield while waiting since they may outnumber the cores
+class spin_barrier
+{
+public:
+    explicit spin_barrier(int64_t _n)
+    : m_size(_n)
+    , m_count(0)
+    , m_generation(0)
+    {
+    }
+
+    void wait()
+    {
+        auto _gen = m_generation.load(std::memory_order_acquire);
+        if(m_count.fetch_add(1, std::memory_order_acq_rel) + 1 == m_size)
+        {
+            m_count.store(0, std::memory_order_relaxed);
+            m_generation.fetch_add(1, std::memory_order_acq_rel);
+            return;
+        }
+        while(m_generation.load(std::memory_order_acquire) == _gen)
+            std::this_thread::yield();
+    }
+
+private:
+    int64_t              m_size;
+    std::atomic<int64_t> m_count;
+    std::atomic<int64_t> m_generation;
+};
+
+}  // namespace
+
+//======================================================================================//
+// label 0 ("contention_shared") is shared by all the threads, label 1 + tid
+// ("contention_<tid>") is private to a thread. When mixed, exactly
+// floor(nregions * overlap) regions of every thread are spread evenly over the shared
+// label
+
+int64_t
+contention_label(sharing pattern, const contention_config& cfg, int64_t tid, int64_t idx)
+{
+    switch(pattern)
+    {
+        case sharing::shared: return 0;
+        case sharing::priv: return 1 + tid;
+        case sharing::mixed:
+        {
+            auto _beg = std::floor(idx * cfg.overlap);
+            auto _end = std::floor((idx + 1) * cfg.overlap);
+            return (_end > _beg) ? 0 : 1 + tid;
+        }
+    }
+    return 0;
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::none>::value> = 0>
+uint64_t
+contention_region(const char*, int64_t seed, const contention_config& cfg)
+{
+    return busy_work(seed, cfg.work);
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::inst>::value> = 0>
+uint64_t
+contention_region(const char* label, int64_t seed, const contention_config& cfg)
+{
+    INSTRUMENT_CREATE_LABEL(label);
+    INSTRUMENT_START_LABEL(label);
+    uint64_t ret = busy_work(seed, cfg.work);
+    INSTRUMENT_STOP_LABEL(label);
+    // the label is unused when the macros are empty
+    (void) label;
+    return ret;
+}
+
+//======================================================================================//
+
+template <typename _Tp>
+uint64_t
+contention_thread(sharing pattern, const contention_config& cfg, int64_t tid)
+{
+    uint64_t ans = 0;
+    for(int64_t i = 0; i < cfg.nregions; ++i)
+    {
+        int64_t idx = contention_label(pattern, cfg, tid, i);
+        ans += contention_region<_Tp>(cfg.labels[idx], idx, cfg);
+    }
+    return ans;
+}
+
+//======================================================================================//
+// the threads are created once per launch and run an untimed entry first so that the
+// per-thread set-up of the tool is not part of the entries. Every entry starts all the
+// threads at once and records the slowest thread
+
+template <typename _Tp>
+uint64_t
+launch(sharing pattern, int64_t nitr, int64_t offset, const contention_config& cfg,
+       cxx_runtime_data& data, contention_totals& totals, cxx_runtime_control* ctrl,
+       int64_t& ncomplete)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    constexpr bool is_inst = std::is_same<_Tp, mode::inst>::value;
+    int64_t inst_count     = (is_inst) ? (cfg.nthreads * cfg.nregions) : 0;
+    ncomplete              = 0;
+
+    std::vector<uint64_t>    answers(cfg.nthreads, 0);
+    std::vector<double>      elapsed(cfg.nthreads, 0.0);
+    std::vector<std::thread> workers;
+    std::atomic<bool>        stop(false);
+    spin_barrier             barrier(cfg.nthreads);
+
+    auto _entry = [&](int64_t tid) {
+        auto t_beg = wtime();
+        answers[tid] += contention_thread<_Tp>(pattern, cfg, tid);
+        elapsed[tid] = wtime() - t_beg;
+    };
+
+    auto _func = [&](int64_t tid) {
+        contention_thread<_Tp>(pattern, cfg, tid);
+        for(;;)
+        {
+            barrier.wait();
+            if(stop.load(std::memory_order_acquire))
+                break;
+            _entry(tid);
+            barrier.wait();
+        }
+    };
+
+    // the first thread is the calling thread
+    for(int64_t j = 1; j < cfg.nthreads; ++j)
+        workers.push_back(std::thread(_func, j));
+    contention_thread<_Tp>(pattern, cfg, 0);
+
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && is_inst)
+            ctrl->begin(offset + i);
+        barrier.wait();
+        _entry(0);
+        barrier.wait();
+        double t_diff = *std::max_element(elapsed.begin(), elapsed.end());
+        for(auto itr : elapsed)
+        {
+            totals.elapsed += itr;
+            totals.throughput += (itr > 0.0) ? cfg.nregions / itr : 0.0;
+        }
+        ++ncomplete;
+        data += entry_t(offset + i, inst_count, t_diff);
+        // only the instrumented entries are streamed
+        if(ctrl && is_inst)
+            ctrl->notify(
+                cxx_trial_record(offset + i, inst_count, t_diff, inst_count / t_diff));
+    }
+
+    stop.store(true, std::memory_order_release);
+    barrier.wait();
+    for(auto& itr : workers)
+        itr.join();
+
+    uint64_t ans = 0;
+    for(auto itr : answers)
+        ans += itr;
+    return ans;
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_contention(int64_t nthreads, int64_t nregions, int64_t work, double overlap,
+                       int64_t nitr, cxx_runtime_control* ctrl,
+                       cxx_runtime_data* reference)
+{
+    if(nthreads < 1 || nregions < 1)
+        throw std::runtime_error("contention requires nthreads >= 1 and nregions >= 1");
+    if(overlap < 0.0 || overlap > 1.0)
+        throw std::runtime_error("contention requires 0 <= overlap <= 1");
+
+    const sharing     patterns[] = { sharing::shared, sharing::priv, sharing::mixed };
+    const char*       names[]    = { "shared", "private", "mixed" };
+    contention_config cfg        = { nthreads, nregions, work, overlap, {} };
+    cxx_runtime_data  data(3 * nitr);
+    cxx_runtime_data  none_data(3 * nitr);
+
+    cfg.labels.push_back(persistent_label("contention_shared"));
+    for(int64_t i = 0; i < nthreads; ++i)
+        cfg.labels.push_back(persistent_label("contention_" + std::to_string(i)));
+
+    std::cout << "\nRunning " << nitr << " iterations of contention(threads = "
+              << nthreads << ", regions = " << nregions << ", work = " << work
+              << ", overlap = " << overlap << ")..." << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline and instruction mode of every sharing pattern
+    //----------------------------------------------------------------------------------//
+    double per_call[3] = { 0.0, 0.0, 0.0 };
+    for(int p = 0; p < 3; ++p)
+    {
+        contention_totals none_totals;
+        contention_totals inst_totals;
+        int64_t           ncomplete = 0;
+        auto ans_none = launch<mode::none>(patterns[p], nitr, p * nitr, cfg, none_data,
+                                           none_totals, ctrl, ncomplete);
+        auto ans_inst = launch<mode::inst>(patterns[p], nitr, p * nitr, cfg, data,
+                                           inst_totals, ctrl, ncomplete);
+
+        if(ncomplete < nitr)
+        {
+            // answers are not comparable after stopping early
+            if(reference)
+                *reference = none_data;
+            data.resize(p * nitr + ncomplete);
+            return data;
+        }
+
+        // we need to use these values so they don't get optimized away
+        if(ans_none != ans_inst)
+        {
+            std::stringstream ss;
+            ss << "Answer w/o instrumentation != answer w/ instrumentation : " << ans_none
+               << " vs. " << ans_inst;
+            throw std::runtime_error(ss.str());
+        }
+
+        // throughput in regions per second per thread
+        double _per  = (nitr > 0) ? 1.0 / (nthreads * nitr) : 0.0;
+        double _diff = inst_totals.elapsed - none_totals.elapsed;
+        per_call[p]  = _diff * _per / nregions;
+
+        std::string _name                          = names[p];
+        data.metrics["throughput_" + _name]        = inst_totals.throughput * _per;
+        data.metrics["base_throughput_" + _name]   = none_totals.throughput * _per;
+        data.metrics["overhead_per_call_" + _name] = per_call[p];
+    }
+
+    if(reference)
+        *reference = none_data;
+
+    double _shared  = data.metrics["throughput_shared"];
+    double _private = data.metrics["throughput_private"];
+
+    // the private labels do not contend, so the difference of the overhead w.r.t. the
+    // private labels is the penalty of sharing a label (false sharing, locks)
+    data.metrics["nthreads"]           = nthreads;
+    data.metrics["nregions"]           = nregions;
+    data.metrics["work"]               = work;
+    data.metrics["overlap"]            = overlap;
+    data.metrics["contention_penalty"] = per_call[0] - per_call[1];
+    data.metrics["mixed_penalty"]      = per_call[2] - per_call[1];
+    data.metrics["contention_ratio"] =
+        (per_call[1] > 0.0) ? per_call[0] / per_call[1] : 0.0;
+    data.metrics["throughput_loss"] = (_private > 0.0) ? 1.0 - _shared / _private : 0.0;
+    return data;
+}
+
+//======================================================================================//
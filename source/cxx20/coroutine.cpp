@@ -0,0 +1,404 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+//======================================================================================//
+//
+//  Pipelined coroutines on a local executor (requires C++20, see USE_COROUTINES).
+//
+//  Every task runs nstages regions. A region is started, does half of its work,
+//  suspends (co_await) and is resumed by any executor thread, does the other half of
+//  its work and is stopped. The stop is therefore frequently on a different thread
+//  than the start and, on both threads, regions of other tasks are started and
+//  stopped while it is open, i.e. the regions of a thread do not nest.
+//
+//======================================================================================//
+
+namespace
+{
+//--------------------------------------------------------------------------------------//
+// FIFO of suspended coroutines resumed by nthreads worker threads
+class local_executor
+{
+public:
+    explicit local_executor(int64_t nthreads)
+    : m_depth(nthreads, std::vector<int64_t>(2, 0))
+    {
+        for(int64_t i = 0; i < nthreads; ++i)
+            m_threads.emplace_back([this, i]() { execute(i); });
+    }
+
+    ~local_executor() { join(); }
+
+    struct awaiter
+    {
+        local_executor* exec;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { exec->push(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    // co_await schedule() resumes the coroutine on one of the worker threads
+    awaiter schedule() { return awaiter{ this }; }
+
+    void push(std::coroutine_handle<> handle)
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_queue.push_back(handle);
+        }
+        m_cv.notify_one();
+    }
+
+    // waits until the queue is drained and the workers exit
+    void join()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_done = true;
+        }
+        m_cv.notify_all();
+        for(auto& itr : m_threads)
+            itr.join();
+        m_threads.clear();
+    }
+
+    // depth of the region stack of the tool on each worker before and after
+    const std::vector<std::vector<int64_t>>& depth() const { return m_depth; }
+
+private:
+    void execute(int64_t idx)
+    {
+        m_depth[idx][0] = INSTRUMENT_QUERY_DEPTH();
+        while(true)
+        {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock<std::mutex> lk(m_mutex);
+                m_cv.wait(lk, [this]() { return m_done || !m_queue.empty(); });
+                if(m_queue.empty())
+                    break;
+                handle = m_queue.front();
+                m_queue.pop_front();
+            }
+            handle.resume();
+        }
+        m_depth[idx][1] = INSTRUMENT_QUERY_DEPTH();
+    }
+
+    bool                                 m_done = false;
+    std::mutex                           m_mutex;
+    std::condition_variable              m_cv;
+    std::deque<std::coroutine_handle<>>  m_queue;
+    std::vector<std::thread>             m_threads;
+    std::vector<std::vector<int64_t>>    m_depth;
+};
+
+//--------------------------------------------------------------------------------------//
+// fire-and-forget coroutine, the frame is destroyed when the body completes
+struct detached_task
+{
+    struct promise_type
+    {
+        detached_task       get_return_object() { return {}; }
+        std::suspend_never  initial_suspend() noexcept { return {}; }
+        std::suspend_never  final_suspend() noexcept { return {}; }
+        void                return_void() {}
+        void                unhandled_exception() { std::abort(); }
+    };
+};
+
+//--------------------------------------------------------------------------------------//
+// what the regions of an entry experienced
+struct pipeline_state
+{
+    std::atomic<int64_t>  remaining{ 0 };
+    std::atomic<int64_t>  migrations{ 0 };
+    std::atomic<int64_t>  interleaved{ 0 };
+    std::atomic<uint64_t> answer{ 0 };
+    std::mutex            mutex;
+    std::condition_variable cv;
+};
+
+// regions open on a thread in the order they were started there. Stopping a region
+// on another thread removes it from the stack of the thread which started it
+struct region_stack
+{
+    std::mutex           mutex;
+    std::vector<int64_t> ids;
+};
+
+thread_local region_stack open_regions;
+
+struct pipeline_config
+{
+    int64_t ntasks;
+    int64_t nstages;
+    int64_t work;
+};
+
+//--------------------------------------------------------------------------------------//
+
+region_stack*
+pipeline_open(int64_t id)
+{
+    region_stack*               stack = &open_regions;
+    std::lock_guard<std::mutex> lk(stack->mutex);
+    stack->ids.push_back(id);
+    return stack;
+}
+
+//--------------------------------------------------------------------------------------//
+// a region is migrated if it is stopped on another thread than it was started on and
+// interleaved if it is not the last region still open on the thread it was started on
+void
+pipeline_close(int64_t id, region_stack* stack, pipeline_state& state)
+{
+    if(stack != &open_regions)
+        state.migrations.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lk(stack->mutex);
+    auto&                       ids = stack->ids;
+    if(ids.empty() || ids.back() != id)
+        state.interleaved.fetch_add(1, std::memory_order_relaxed);
+    for(auto itr = ids.rbegin(); itr != ids.rend(); ++itr)
+    {
+        if(*itr == id)
+        {
+            ids.erase(std::next(itr).base());
+            break;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+template <bool _Inst>
+detached_task
+pipeline_task(int64_t task, pipeline_config cfg, local_executor& exec,
+              pipeline_state& state)
+{
+    // start on a worker thread
+    co_await exec.schedule();
+
+    uint64_t val = task;
+    for(int64_t stage = 0; stage < cfg.nstages; ++stage)
+    {
+        int64_t id    = task * cfg.nstages + stage;
+        auto*   stack = pipeline_open(id);
+        if constexpr(_Inst)
+        {
+            INSTRUMENT_CREATE(stage);
+            INSTRUMENT_START(stage);
+            val = busy_work(val, cfg.work / 2);
+            co_await exec.schedule();
+            val = busy_work(val, cfg.work - cfg.work / 2);
+            pipeline_close(id, stack, state);
+            INSTRUMENT_STOP(stage);
+        }
+        else
+        {
+            val = busy_work(val, cfg.work / 2);
+            co_await exec.schedule();
+            val = busy_work(val, cfg.work - cfg.work / 2);
+            pipeline_close(id, stack, state);
+        }
+    }
+
+    state.answer.fetch_add(val, std::memory_order_relaxed);
+    if(state.remaining.fetch_sub(1) == 1)
+    {
+        std::lock_guard<std::mutex> lk(state.mutex);
+        state.cv.notify_all();
+    }
+}
+
+}  // namespace
+
+//======================================================================================//
+// runs the tasks of one entry on the executor and waits for them. The last task may
+// still use the state after it was counted, so the state outlives the executor threads
+
+template <bool _Inst>
+uint64_t
+run_pipeline(const pipeline_config& cfg, local_executor& exec, pipeline_state& state)
+{
+    state.answer.store(0);
+    state.remaining.store(cfg.ntasks);
+    for(int64_t t = 0; t < cfg.ntasks; ++t)
+        pipeline_task<_Inst>(t, cfg, exec, state);
+    std::unique_lock<std::mutex> lk(state.mutex);
+    state.cv.wait(lk, [&state]() { return state.remaining.load() == 0; });
+    return state.answer.load();
+}
+
+//======================================================================================//
+
+template <bool _Inst>
+uint64_t
+launch(int64_t nitr, const pipeline_config& cfg, local_executor& exec,
+       pipeline_state& state, cxx_runtime_data& data, cxx_runtime_control* ctrl,
+       int64_t& ncomplete)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    int64_t  inst_count = (_Inst) ? (cfg.ntasks * cfg.nstages) : 0;
+    uint64_t ans        = 0;
+    ncomplete           = 0;
+
+    // untimed entry so that the set-up of the tool on the workers is excluded
+    run_pipeline<_Inst>(cfg, exec, state);
+    state.migrations.store(0);
+    state.interleaved.store(0);
+
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && _Inst)
+            ctrl->begin(i);
+
+        auto t_beg  = wtime();
+        ans += run_pipeline<_Inst>(cfg, exec, state);
+        auto t_diff = wtime() - t_beg;
+
+        ++ncomplete;
+        data += entry_t(i, inst_count, t_diff);
+        // only the instrumented entries are streamed
+        if(ctrl && _Inst)
+            ctrl->notify(cxx_trial_record(i, inst_count, t_diff, inst_count / t_diff));
+    }
+    return ans;
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_coroutine(int64_t ntasks, int64_t nstages, int64_t work, int64_t nthreads,
+                      int64_t nitr, cxx_runtime_control* ctrl,
+                      cxx_runtime_data* reference)
+{
+    if(ntasks < 1 || nstages < 1 || nthreads < 1)
+        throw std::runtime_error(
+            "coroutine test requires ntasks >= 1, nstages >= 1 and nthreads >= 1");
+
+    pipeline_config  cfg = { ntasks, nstages, work };
+    cxx_runtime_data data(nitr);
+    cxx_runtime_data none_data(nitr);
+
+    std::cout << "\nRunning " << nitr << " iterations of coroutine pipeline(ntasks = "
+              << ntasks << ", nstages = " << nstages << ", work = " << work
+              << ", nthreads = " << nthreads << ")..." << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline (warm-up) and instruction mode
+    //----------------------------------------------------------------------------------//
+    // the workers are created once, outside of the timed entries, and reused by both
+    // modes. They are joined before the state they may still use is destroyed
+    pipeline_state state;
+    local_executor exec(nthreads);
+    int64_t        ncomplete = 0;
+    auto ans_none = launch<false>(nitr, cfg, exec, state, none_data, ctrl, ncomplete);
+    auto ans_inst = launch<true>(nitr, cfg, exec, state, data, ctrl, ncomplete);
+    exec.join();
+
+    if(reference)
+        *reference = none_data;
+
+    if(ncomplete < nitr)
+    {
+        // answers are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
+    }
+
+    // we need to use these values so they don't get optimized away
+    if(ans_none != ans_inst)
+    {
+        std::stringstream ss;
+        ss << "Answer w/o instrumentation != answer w/ instrumentation : " << ans_none
+           << " vs. " << ans_inst;
+        throw std::runtime_error(ss.str());
+    }
+
+    auto&  _none   = none_data.timing;
+    double t_none  = std::accumulate(_none.begin(), _none.end(), 0.0);
+    double t_inst  = std::accumulate(data.timing.begin(), data.timing.end(), 0.0);
+    double regions = static_cast<double>(ntasks * nstages);
+    double ncalls  = regions * nitr;
+
+    data.metrics["ntasks"]            = ntasks;
+    data.metrics["nstages"]           = nstages;
+    data.metrics["work"]              = work;
+    data.metrics["nthreads"]          = nthreads;
+    data.metrics["regions"]           = regions;
+    data.metrics["base_timing"]       = (nitr > 0) ? t_none / nitr : 0.0;
+    data.metrics["overhead_per_call"] = (nitr > 0) ? (t_inst - t_none) / ncalls : 0.0;
+    // fraction of the regions stopped on another thread / out of order (the counters
+    // hold the instrumented entries)
+    data.metrics["migrated"]    = (nitr > 0) ? state.migrations.load() / ncalls : 0.0;
+    data.metrics["interleaved"] = (nitr > 0) ? state.interleaved.load() / ncalls : 0.0;
+    // total change of the region depth of the tool (INSTRUMENT_QUERY_DEPTH) on the
+    // workers over both modes, for the workers where the tool reports it
+    double depth_checked = 0.0;
+    double depth_errors  = 0.0;
+    for(const auto& itr : exec.depth())
+    {
+        if(itr[0] == INSTRUMENT_DEPTH_UNKNOWN || itr[1] == INSTRUMENT_DEPTH_UNKNOWN)
+            continue;
+        depth_checked += 1;
+        depth_errors += std::abs(itr[1] - itr[0]);
+    }
+    data.metrics["depth_checked"] = depth_checked;
+    data.metrics["depth_errors"]  = depth_errors;
+    return data;
+}
+
+//======================================================================================//
@@ -41,17 +41,15 @@
 static int64_t nmeasure = 0;
 using result_type       = std::tuple<int64_t, double>;
 
-template <bool _Ret, typename _Tp = int>
-using enable_if = typename std::enable_if<_Ret, _Tp>::type;
-
+namespace
+{
 namespace mode
 {
 // clang-format off
-struct none  {};
-struct inst  {};
 struct count {};
 // clang-format on
 }  // namespace mode
+}  // namespace
 
 //======================================================================================//
 
@@ -118,29 +116,43 @@ run(int64_t n, int64_t cutoff)
 template <typename _Tp>
 int64_t
 launch(const int64_t& nitr, const int64_t& nfib, const int64_t& cutoff,
-       cxx_runtime_data& data, bool record)
+       cxx_runtime_data& data, bool record, cxx_runtime_control* ctrl,
+       int64_t& ncomplete)
 {
     using entry_t = std::tuple<int64_t, int64_t, double>;
 
-    // count the number of measurements and warm-up
+    // count the number of measurements per entry and warm-up
     nmeasure           = 0;
-    auto    ans_count  = fib<mode::count>(nfib, cutoff) * nitr;
-    int64_t inst_count = (nmeasure * nitr);
+    auto    ans_count  = fib<mode::count>(nfib, cutoff);
+    int64_t inst_count = nmeasure;
     int64_t ans_run    = 0;
+    ncomplete          = 0;
     for(int i = 0; i < nitr; ++i)
     {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && !std::is_same<_Tp, mode::none>::value)
+            ctrl->begin(i);
         auto&& ret = run<_Tp>(nfib, cutoff);
         ans_run += std::get<0>(ret);
+        ++ncomplete;
         if(record)
-            data += entry_t(i, inst_count, std::get<1>(ret));
+        {
+            auto t_diff = std::get<1>(ret);
+            data += entry_t(i, inst_count, t_diff);
+            // only the instrumented entries are streamed
+            if(ctrl && !std::is_same<_Tp, mode::none>::value)
+                ctrl->notify(
+                    cxx_trial_record(i, inst_count, t_diff, inst_count / t_diff));
+        }
     }
 
     // we need to use these values so they don't get optimized away
-    if(ans_count != ans_run)
+    if(ans_count * ncomplete != ans_run)
     {
         std::stringstream ss;
-        ss << "Answer w/ counting != answer during run : " << ans_count << " vs. "
-           << ans_run;
+        ss << "Answer w/ counting != answer during run : " << ans_count * ncomplete
+           << " vs. " << ans_run;
         throw std::runtime_error(ss.str());
     }
     return ans_run;
@@ -149,9 +161,11 @@ launch(const int64_t& nitr, const int64_t& nfib, const int64_t& cutoff,
 //======================================================================================//
 
 cxx_runtime_data
-cxx_execute_fibonacci(int64_t nfib, int64_t cutoff, int64_t nitr)
+cxx_execute_fibonacci(int64_t nfib, int64_t cutoff, int64_t nitr,
+                      cxx_runtime_control* ctrl, cxx_runtime_data* reference)
 {
     cxx_runtime_data data(nitr);
+    cxx_runtime_data none_data(nitr);
 
     std::cout << "\nRunning " << nitr << " iterations of fib(n = " << nfib
               << ", cutoff = " << cutoff << ")..." << std::endl;
@@ -159,8 +173,20 @@ cxx_execute_fibonacci(int64_t nfib, int64_t cutoff, int64_t nitr)
     //----------------------------------------------------------------------------------//
     //      run baseline (warm-up) and instruction mode
     //----------------------------------------------------------------------------------//
-    auto ans_none = launch<mode::none>(nitr, nfib, nfib, data, false);
-    auto ans_inst = launch<mode::inst>(nitr, nfib, cutoff, data, true);
+    int64_t ncomplete = 0;
+    auto    ans_none =
+        launch<mode::none>(nitr, nfib, nfib, none_data, true, ctrl, ncomplete);
+    auto ans_inst = launch<mode::inst>(nitr, nfib, cutoff, data, true, ctrl, ncomplete);
+
+    if(reference)
+        *reference = none_data;
+
+    if(ncomplete < nitr)
+    {
+        // answers are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
+    }
 
     // we need to use these values so they don't get optimized away
     if(ans_none != ans_inst)
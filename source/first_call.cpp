@@ -0,0 +1,254 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+struct first_call_config
+{
+    int64_t nlabels;
+    int64_t ncold;  // invocations of each label timed separately
+    int64_t nwarm;  // further invocations of each label (steady state)
+    int64_t work;
+    // distinct label of every region of every entry, indexed by entry * nlabels + label
+    std::vector<const char*> labels;
+};
+
+// sum of the latencies of the k-th invocation of every label and of the steady state
+struct first_call_latency
+{
+    std::vector<double> cold;
+    double              warm = 0.0;
+};
+
+// keeps the cache flushes from being optimized away
+volatile uint64_t first_call_sink = 0;
+
+}  // namespace
+
+//======================================================================================//
+// evicts the working set of the previous region (and of the tool) from the caches by
+// writing and reading a buffer larger than the caches
+
+uint64_t
+first_call_flush(std::vector<uint64_t>& buffer)
+{
+    uint64_t ret = 0;
+    for(size_t i = 0; i < buffer.size(); i += 8)
+        buffer[i] += 1;
+    for(size_t i = 0; i < buffer.size(); i += 8)
+        ret += buffer[i];
+    return ret;
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::none>::value> = 0>
+uint64_t
+first_call_region(const char*, int64_t seed, int64_t work)
+{
+    return busy_work(seed, work);
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::inst>::value> = 0>
+uint64_t
+first_call_region(const char* label, int64_t seed, int64_t work)
+{
+    INSTRUMENT_CREATE_LABEL(label);
+    INSTRUMENT_START_LABEL(label);
+    uint64_t ret = busy_work(seed, work);
+    INSTRUMENT_STOP_LABEL(label);
+    // the label is unused when the macros are empty
+    (void) label;
+    return ret;
+}
+
+//======================================================================================//
+// every entry uses labels the tool has not seen: pass k invokes every label for the
+// k-th time, the first ncold passes are cold (optionally with flushed caches)
+
+template <typename _Tp>
+uint64_t
+launch(int64_t nitr, const first_call_config& cfg, std::vector<uint64_t>& buffer,
+       first_call_latency& latency, cxx_runtime_data& data, cxx_runtime_control* ctrl,
+       int64_t& ncomplete)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    constexpr bool is_inst    = std::is_same<_Tp, mode::inst>::value;
+    int64_t        npass      = cfg.ncold + cfg.nwarm;
+    int64_t        inst_count = (is_inst) ? (cfg.nlabels * npass) : 0;
+    uint64_t       ans        = 0;
+    uint64_t       sink       = 0;
+    ncomplete                 = 0;
+    latency.cold.assign(cfg.ncold, 0.0);
+    latency.warm = 0.0;
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && is_inst)
+            ctrl->begin(i);
+        double t_total = 0.0;
+        for(int64_t p = 0; p < npass; ++p)
+        {
+            bool cold = (p < cfg.ncold);
+            for(int64_t j = 0; j < cfg.nlabels; ++j)
+            {
+                if(cold && !buffer.empty())
+                    sink += first_call_flush(buffer);
+                auto t_beg = wtime();
+                int64_t idx = i * cfg.nlabels + j;
+                ans += first_call_region<_Tp>(cfg.labels[idx], idx, cfg.work);
+                auto t_diff = wtime() - t_beg;
+                t_total += t_diff;
+                if(cold)
+                    latency.cold[p] += t_diff;
+                else
+                    latency.warm += t_diff;
+            }
+        }
+        ++ncomplete;
+        data += entry_t(i, inst_count, t_total);
+        // only the instrumented entries are streamed
+        if(ctrl && is_inst)
+            ctrl->notify(cxx_trial_record(i, inst_count, t_total, inst_count / t_total));
+    }
+    first_call_sink = sink;
+    return ans;
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_first_call(int64_t nlabels, int64_t ncold, int64_t nwarm, int64_t work,
+                       int64_t flush_bytes, int64_t nitr, cxx_runtime_control* ctrl,
+                       cxx_runtime_data* reference)
+{
+    if(nlabels < 1 || ncold < 1 || nwarm < 1)
+        throw std::runtime_error("first call requires nlabels, ncold and nwarm >= 1");
+
+    // the labels of a run differ from the ones of the previous runs
+    static int64_t nruns = 0;
+    int64_t        run   = nruns++;
+
+    first_call_config cfg = { nlabels, ncold, nwarm, work, {} };
+    for(int64_t i = 0; i < nitr * nlabels; ++i)
+    {
+        std::stringstream ss;
+        ss << "first_call_" << run << "_" << i;
+        cfg.labels.push_back(persistent_label(ss.str()));
+    }
+
+    first_call_latency    none_latency;
+    first_call_latency    inst_latency;
+    std::vector<uint64_t> buffer(std::max<int64_t>(flush_bytes, 0) / sizeof(uint64_t),
+                                 0);
+    cxx_runtime_data      data(nitr);
+    cxx_runtime_data      none_data(nitr);
+
+    std::cout << "\nRunning " << nitr << " iterations of first call(labels = " << nlabels
+              << ", cold = " << ncold << ", warm = " << nwarm << ", work = " << work
+              << ", flush = " << flush_bytes << " bytes)..." << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline and instruction mode -- no warm-up of the instrumented labels
+    //----------------------------------------------------------------------------------//
+    int64_t ncomplete = 0;
+    auto    ans_none =
+        launch<mode::none>(nitr, cfg, buffer, none_latency, none_data, ctrl, ncomplete);
+    auto ans_inst =
+        launch<mode::inst>(nitr, cfg, buffer, inst_latency, data, ctrl, ncomplete);
+
+    if(reference)
+        *reference = none_data;
+
+    if(ncomplete < nitr)
+    {
+        // answers are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
+    }
+
+    // we need to use these values so they don't get optimized away
+    if(ans_none != ans_inst)
+    {
+        std::stringstream ss;
+        ss << "Answer w/o instrumentation != answer w/ instrumentation : " << ans_none
+           << " vs. " << ans_inst;
+        throw std::runtime_error(ss.str());
+    }
+
+    // mean latency and overhead per call of each cold invocation and of the warm calls
+    double ncalls = static_cast<double>(nlabels * nitr);
+    double _warm  = (nitr > 0) ? inst_latency.warm / (ncalls * nwarm) : 0.0;
+    double _diff  = inst_latency.warm - none_latency.warm;
+    double _over  = (nitr > 0) ? _diff / (ncalls * nwarm) : 0.0;
+
+    data.metrics["nlabels"]       = nlabels;
+    data.metrics["ncold"]         = ncold;
+    data.metrics["nwarm"]         = nwarm;
+    data.metrics["work"]          = work;
+    data.metrics["flush_bytes"]   = flush_bytes;
+    data.metrics["warm_latency"]  = _warm;
+    data.metrics["warm_overhead"] = _over;
+    for(int64_t k = 0; k < ncold; ++k)
+    {
+        double _cold = (nitr > 0) ? inst_latency.cold[k] / ncalls : 0.0;
+        double _diff =
+            (nitr > 0) ? (inst_latency.cold[k] - none_latency.cold[k]) / ncalls : 0.0;
+        data.metrics["cold_latency_" + std::to_string(k)]  = _cold;
+        data.metrics["cold_overhead_" + std::to_string(k)] = _diff;
+    }
+    // first invocation of a label w.r.t. the steady state
+    data.metrics["cold_warm_ratio"] =
+        (_over > 0.0) ? data.metrics["cold_overhead_0"] / _over : 0.0;
+    data.metrics["cold_warm_latency_ratio"] =
+        (_warm > 0.0) ? data.metrics["cold_latency_0"] / _warm : 0.0;
+    return data;
+}
+
+//======================================================================================//
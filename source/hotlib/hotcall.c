@@ -0,0 +1,50 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Caller library: the references to the hot functions are resolved by the dynamic
+// linker when this library is loaded, so they can be interposed (LD_PRELOAD) or have
+// their GOT entries rewritten after loading.
+//
+
+#include "hotlib.h"
+
+#define HOTCALL_CASE(N)                                                                  \
+    case N: val = hotlib_fn_##N(val, work); break;
+
+uint64_t
+hotcall_run(int64_t nsymbols, int64_t ncalls, int64_t work, uint64_t seed)
+{
+    uint64_t val = seed;
+    int64_t  k   = 0;
+    for(int64_t i = 0; i < ncalls; ++i)
+    {
+        switch(k)
+        {
+            HOTLIB_SYMBOLS(HOTCALL_CASE)
+            default: break;
+        }
+        if(++k == nsymbols)
+            k = 0;
+    }
+    return val;
+}
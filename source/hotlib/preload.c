@@ -0,0 +1,46 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Plain LD_PRELOAD-style wrappers: each one looks up the next definition of the
+// function once (dlsym with RTLD_NEXT) and forwards to it.
+//
+
+#if !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+
+#include "hotlib.h"
+
+#include <dlfcn.h>
+#include <stddef.h>
+
+#define HOTLIB_PRELOAD(N)                                                                \
+    uint64_t hotlib_fn_##N(uint64_t val, int64_t work)                                   \
+    {                                                                                    \
+        static hotlib_fn_t _next = NULL;                                                 \
+        if(__builtin_expect(_next == NULL, 0))                                           \
+            _next = (hotlib_fn_t) dlsym(RTLD_NEXT, "hotlib_fn_" #N);                     \
+        return _next(val, work);                                                         \
+    }
+
+HOTLIB_SYMBOLS(HOTLIB_PRELOAD)
@@ -0,0 +1,425 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+// fork and shared memory
+#include "process.hpp"
+// hot functions of the bundled shared library
+#include "hotlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// the libraries loaded by the test are only built on Linux (USE_INTERPOSE)
+#if defined(__linux__) && defined(INST_HOTCALL_LIBRARY) &&                              \
+    defined(INST_HOTLIB_PRELOAD_LIBRARY)
+#    define INTERPOSE_AVAILABLE
+#    include <dlfcn.h>
+#    include <link.h>
+#    if __ELF_NATIVE_CLASS == 64
+#        define INTERPOSE_R_SYM(info) ELF64_R_SYM(info)
+#    else
+#        define INTERPOSE_R_SYM(info) ELF32_R_SYM(info)
+#    endif
+#endif
+
+//======================================================================================//
+//
+//  Every mode runs in a forked child which loads the caller library (and the hot
+//  library it depends on) so the bindings of one mode never leak into the next one:
+//
+//      direct      caller -> PLT -> hotlib
+//      preload     the plain wrappers are loaded into the global scope first (as
+//                  LD_PRELOAD does), caller -> PLT -> wrapper -> dlsym(RTLD_NEXT)
+//      got         GOT entries of the caller are rewritten to plain wrappers (GOTCHA)
+//      got_inst    GOT entries are rewritten to wrappers which start/stop a region
+//
+//======================================================================================//
+
+#if defined(INTERPOSE_AVAILABLE)
+
+namespace
+{
+const char* interpose_modes[] = { "direct", "preload", "got", "got_inst" };
+
+constexpr int64_t interpose_nmodes = sizeof(interpose_modes) / sizeof(const char*);
+
+// written by the child, complete is set once the entry is timed
+struct interpose_entry
+{
+    double               timing   = 0.0;
+    uint64_t             checksum = 0;
+    std::atomic<int64_t> complete{ 0 };
+};
+
+// functions the GOT entries pointed to before they were rewritten
+hotlib_fn_t interpose_next[HOTLIB_NSYMBOLS];
+
+}  // namespace
+
+//======================================================================================//
+
+#define INTERPOSE_WRAPPER(N)                                                             \
+    uint64_t interpose_wrapper_##N(uint64_t val, int64_t work)                           \
+    {                                                                                    \
+        return interpose_next[N](val, work);                                             \
+    }
+
+#define INTERPOSE_INST_WRAPPER(N)                                                        \
+    uint64_t interpose_inst_wrapper_##N(uint64_t val, int64_t work)                      \
+    {                                                                                    \
+        INSTRUMENT_CREATE(N);                                                            \
+        INSTRUMENT_START(N);                                                             \
+        uint64_t ret = interpose_next[N](val, work);                                     \
+        INSTRUMENT_STOP(N);                                                              \
+        return ret;                                                                      \
+    }
+
+#define INTERPOSE_WRAPPER_ENTRY(N) &interpose_wrapper_##N,
+#define INTERPOSE_INST_WRAPPER_ENTRY(N) &interpose_inst_wrapper_##N,
+
+HOTLIB_SYMBOLS(INTERPOSE_WRAPPER)
+HOTLIB_SYMBOLS(INTERPOSE_INST_WRAPPER)
+
+namespace
+{
+hotlib_fn_t interpose_wrappers[]      = { HOTLIB_SYMBOLS(INTERPOSE_WRAPPER_ENTRY) };
+hotlib_fn_t interpose_inst_wrappers[] = {
+    HOTLIB_SYMBOLS(INTERPOSE_INST_WRAPPER_ENTRY)
+};
+}  // namespace
+
+//======================================================================================//
+
+namespace
+{
+struct got_search
+{
+    const char*         object;
+    int64_t             nsymbols;
+    std::vector<void**> slots;
+};
+
+//--------------------------------------------------------------------------------------//
+// pointers in the dynamic section are relocated by glibc on most architectures
+template <typename _Tp>
+_Tp*
+dynamic_ptr(const dl_phdr_info* info, ElfW(Addr) ptr)
+{
+    return reinterpret_cast<_Tp*>((ptr < info->dlpi_addr) ? info->dlpi_addr + ptr : ptr);
+}
+
+//--------------------------------------------------------------------------------------//
+// finds the GOT entries (PLT or, with -fno-plt, GLOB_DAT) of hotlib_fn_<N>, N < nsymbols
+int
+find_got_slots(dl_phdr_info* info, size_t, void* data)
+{
+    auto* search = static_cast<got_search*>(data);
+    if(!info->dlpi_name || !strstr(info->dlpi_name, search->object))
+        return 0;
+
+    const ElfW(Dyn)* dyn = nullptr;
+    for(ElfW(Half) i = 0; i < info->dlpi_phnum; ++i)
+    {
+        if(info->dlpi_phdr[i].p_type == PT_DYNAMIC)
+            dyn = reinterpret_cast<const ElfW(Dyn)*>(info->dlpi_addr +
+                                                     info->dlpi_phdr[i].p_vaddr);
+    }
+    if(!dyn)
+        return 0;
+
+    const ElfW(Sym)*  symtab    = nullptr;
+    const char*       strtab    = nullptr;
+    const ElfW(Rela)* tables[2] = { nullptr, nullptr };
+    size_t            sizes[2]  = { 0, 0 };
+    ElfW(Sxword)      pltrel    = DT_RELA;
+    for(; dyn->d_tag != DT_NULL; ++dyn)
+    {
+        auto ptr = dyn->d_un.d_ptr;
+        switch(dyn->d_tag)
+        {
+            case DT_SYMTAB: symtab = dynamic_ptr<ElfW(Sym)>(info, ptr); break;
+            case DT_STRTAB: strtab = dynamic_ptr<char>(info, ptr); break;
+            case DT_JMPREL: tables[0] = dynamic_ptr<ElfW(Rela)>(info, ptr); break;
+            case DT_PLTRELSZ: sizes[0] = dyn->d_un.d_val; break;
+            case DT_RELA: tables[1] = dynamic_ptr<ElfW(Rela)>(info, ptr); break;
+            case DT_RELASZ: sizes[1] = dyn->d_un.d_val; break;
+            case DT_PLTREL: pltrel = dyn->d_un.d_val; break;
+            default: break;
+        }
+    }
+
+    if(pltrel != DT_RELA)
+        throw std::runtime_error("GOT rewriting requires RELA relocations");
+
+    search->slots.assign(search->nsymbols, nullptr);
+    for(int t = 0; t < 2; ++t)
+    {
+        for(size_t i = 0; tables[t] && i < sizes[t] / sizeof(ElfW(Rela)); ++i)
+        {
+            const char* name = strtab + symtab[INTERPOSE_R_SYM(tables[t][i].r_info)].st_name;
+            if(strncmp(name, "hotlib_fn_", 10) != 0)
+                continue;
+            int64_t idx = atol(name + 10);
+            if(idx < search->nsymbols)
+                search->slots[idx] =
+                    reinterpret_cast<void**>(info->dlpi_addr + tables[t][i].r_offset);
+        }
+    }
+    return 1;
+}
+
+//--------------------------------------------------------------------------------------//
+// rewrite the GOT entries of the caller library (which may be read-only after RELRO)
+void
+rewrite_got(int64_t nsymbols, const hotlib_fn_t* wrappers)
+{
+    got_search search = { "libinst-hotcall", nsymbols, {} };
+    if(dl_iterate_phdr(&find_got_slots, &search) == 0)
+        throw std::runtime_error("caller library is not loaded");
+
+    long page = sysconf(_SC_PAGESIZE);
+    for(int64_t i = 0; i < nsymbols; ++i)
+    {
+        void** slot = search.slots.at(i);
+        if(!slot)
+            throw std::runtime_error("no GOT entry for hotlib_fn_" + std::to_string(i));
+        auto beg = reinterpret_cast<uintptr_t>(slot) & ~(page - 1);
+        if(mprotect(reinterpret_cast<void*>(beg), page, PROT_READ | PROT_WRITE) != 0)
+            throw std::runtime_error(std::string("mprotect failed: ") + strerror(errno));
+        interpose_next[i] = reinterpret_cast<hotlib_fn_t>(*slot);
+        *slot             = reinterpret_cast<void*>(wrappers[i]);
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+// the libraries are built in the parent directory of the submodules, i.e. the parent of
+// the directory of the library containing this test, wherever the package is moved to.
+// Otherwise the dynamic loader searches for them (e.g. LD_LIBRARY_PATH)
+std::string
+interpose_library(const char* name)
+{
+    Dl_info info;
+    if(dladdr(reinterpret_cast<void*>(&interpose_library), &info) && info.dli_fname)
+    {
+        std::string path = info.dli_fname;
+        auto        pos  = path.find_last_of('/');
+        if(pos != std::string::npos)
+        {
+            path = path.substr(0, pos) + "/../" + name;
+            if(access(path.c_str(), R_OK) == 0)
+                return path;
+        }
+    }
+    return name;
+}
+
+//--------------------------------------------------------------------------------------//
+// executed in the child: load, interpose, warm up and time nitr entries until stop is
+// set. The entries of the instrumented mode are announced to ctrl. Returns the time
+// spent setting up the interposition
+double
+interpose_child(int64_t mode, int64_t nsymbols, int64_t ncalls, int64_t work,
+                int64_t nitr, interpose_entry* entries, const std::atomic<int64_t>* stop,
+                cxx_runtime_control* ctrl)
+{
+    auto preload = interpose_library(INST_HOTLIB_PRELOAD_LIBRARY);
+    auto hotcall = interpose_library(INST_HOTCALL_LIBRARY);
+
+    auto t_beg = wtime();
+    if(mode == 1 && !dlopen(preload.c_str(), RTLD_NOW | RTLD_GLOBAL))
+        throw std::runtime_error(dlerror());
+
+    void* handle = dlopen(hotcall.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if(!handle)
+        throw std::runtime_error(dlerror());
+
+    if(mode == 2)
+        rewrite_got(nsymbols, interpose_wrappers);
+    else if(mode == 3)
+        rewrite_got(nsymbols, interpose_inst_wrappers);
+    auto t_setup = wtime() - t_beg;
+
+    using run_t = uint64_t (*)(int64_t, int64_t, int64_t, uint64_t);
+    auto run    = reinterpret_cast<run_t>(dlsym(handle, "hotcall_run"));
+    if(!run)
+        throw std::runtime_error(dlerror());
+
+    // warm-up (resolves the preload wrappers)
+    run(nsymbols, nsymbols, work, 0);
+
+    for(int64_t i = 0; i < nitr && stop->load() == 0; ++i)
+    {
+        if(ctrl && mode == interpose_nmodes - 1)
+            ctrl->begin(i);
+        auto t_entry        = wtime();
+        auto ret            = run(nsymbols, ncalls, work, i);
+        entries[i].timing   = wtime() - t_entry;
+        entries[i].checksum = ret;
+        entries[i].complete.store(1, std::memory_order_release);
+    }
+    return t_setup;
+}
+
+}  // namespace
+
+#endif
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_interpose(int64_t nsymbols, int64_t ncalls, int64_t work, int64_t nitr,
+                      cxx_runtime_control* ctrl, cxx_runtime_data* reference)
+{
+    if(nsymbols < 1 || nsymbols > HOTLIB_NSYMBOLS)
+        throw std::runtime_error("interposition requires 1 <= nsymbols <= " +
+                                 std::to_string(HOTLIB_NSYMBOLS));
+
+    std::cout << "\nRunning " << nitr << " iterations of interposition(nsymbols = "
+              << nsymbols << ", ncalls = " << ncalls << ", work = " << work << ")..."
+              << std::endl;
+
+#if defined(INTERPOSE_AVAILABLE)
+    shared_segment<interpose_entry>      entries(interpose_nmodes * nitr);
+    shared_segment<std::atomic<int64_t>> stop(1);
+    std::vector<double>                  setup(interpose_nmodes, 0.0);
+
+    stop[0].store(0);
+
+    // forwards the entries of the instrumented mode as they complete and tells the
+    // child to stop when the test is interrupted
+    int64_t nnotify = 0;
+    auto    poll    = [&](int64_t _mode) {
+        if(!ctrl)
+            return;
+        auto* _entries = &entries[_mode * nitr];
+        while(_mode == interpose_nmodes - 1 && nnotify < nitr &&
+              _entries[nnotify].complete.load(std::memory_order_acquire) != 0)
+        {
+            auto _timing = _entries[nnotify].timing;
+            ctrl->notify(cxx_trial_record(nnotify, ncalls, _timing, ncalls / _timing));
+            ++nnotify;
+        }
+        if(ctrl->interrupted())
+            stop[0].store(1);
+    };
+
+    int64_t nmodes = 0;
+    for(; nmodes < interpose_nmodes; ++nmodes)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        auto* _entries = &entries[nmodes * nitr];
+        auto* _stop    = &stop[0];
+        setup[nmodes]  = cxx_execute_forked<double>(
+            [=]() {
+                return interpose_child(nmodes, nsymbols, ncalls, work, nitr, _entries,
+                                       _stop, ctrl);
+            },
+            [&]() { poll(nmodes); });
+    }
+
+    // entries completed by every mode (none if the instrumented mode did not run)
+    int64_t ncomplete = (nmodes < interpose_nmodes) ? 0 : nitr;
+    for(int64_t m = 0; m < nmodes; ++m)
+    {
+        int64_t _n = 0;
+        while(_n < nitr && entries[m * nitr + _n].complete.load() != 0)
+            ++_n;
+        ncomplete = std::min(ncomplete, _n);
+    }
+
+    // runtime data of each mode (the last one is the instrumented one)
+    std::vector<cxx_runtime_data> data(interpose_nmodes, cxx_runtime_data(ncomplete));
+    for(int64_t m = 0; m < nmodes; ++m)
+    {
+        for(int64_t i = 0; i < ncomplete; ++i)
+        {
+            const auto& _entry = entries[m * nitr + i];
+            // we need to use these values so they don't get optimized away
+            if(_entry.checksum != entries[i].checksum)
+            {
+                std::stringstream ss;
+                ss << "Answer w/ " << interpose_modes[m] << " != answer w/ direct : "
+                   << _entry.checksum << " vs. " << entries[i].checksum;
+                throw std::runtime_error(ss.str());
+            }
+            int64_t _count = (m == interpose_nmodes - 1) ? ncalls : 0;
+            data[m] += cxx_trial_record(i, _count, _entry.timing, _count / _entry.timing);
+        }
+    }
+
+    if(reference)
+        *reference = data.front();
+
+    auto& ret = data.back();
+    // the metrics are not comparable after stopping early
+    if(ncomplete < nitr)
+        return ret;
+
+    double direct = 0.0;
+    for(int64_t m = 0; m < nmodes; ++m)
+    {
+        auto&       _timing = data[m].timing;
+        std::string _mode   = interpose_modes[m];
+        double      _per    = std::accumulate(_timing.begin(), _timing.end(), 0.0) /
+                      static_cast<double>(std::max<int64_t>(nitr * ncalls, 1));
+        if(m == 0)
+            direct = _per;
+        ret.metrics["per_call_" + _mode] = _per;
+        ret.metrics["setup_" + _mode]    = setup[m];
+        if(m > 0)
+            ret.metrics["wrap_" + _mode] = _per - direct;
+    }
+    ret.metrics["nsymbols"] = nsymbols;
+    ret.metrics["ncalls"]   = ncalls;
+    ret.metrics["work"]     = work;
+    return ret;
+#else
+    (void) ncalls;
+    (void) work;
+    (void) nitr;
+    (void) ctrl;
+    (void) reference;
+    throw std::runtime_error("interposition libraries were not built (USE_INTERPOSE)");
+#endif
+}
+
+//======================================================================================//
@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------//
+
+// a single region with a distinct label
+void
+lifecycle_region(int64_t n)
+{
+    INSTRUMENT_CREATE(n);
+    INSTRUMENT_START(n);
+    INSTRUMENT_STOP(n);
+    // the label is unused when the macros are empty
+    (void) n;
+}
+
+//--------------------------------------------------------------------------------------//
+
+cxx_lifecycle_data
+cxx_execute_lifecycle(int64_t nregions)
+{
+    cxx_lifecycle_data data;
+    data.nregions = nregions;
+
+    auto t_configure = wtime();
+    INSTRUMENT_CONFIGURE();
+
+    auto t_first = wtime();
+    if(nregions > 0)
+        lifecycle_region(0);
+
+    auto t_regions = wtime();
+    for(int64_t i = 1; i < nregions; ++i)
+        lifecycle_region(i);
+
+    auto t_finalize = wtime();
+    INSTRUMENT_FINALIZE();
+    auto t_end = wtime();
+
+    data.configure    = t_first - t_configure;
+    data.first_region = t_regions - t_first;
+    data.regions      = t_finalize - t_regions;
+    data.finalize     = t_end - t_finalize;
+    data.exit_begin   = t_end;
+    return data;
+}
+
+//--------------------------------------------------------------------------------------//
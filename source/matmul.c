@@ -102,6 +102,15 @@ mm_reset(int64_t s, double* a, double* b, double* c)
 
 c_runtime_data
 c_execute_matmul(int64_t s, int64_t imax, int64_t nitr)
+{
+    return c_execute_matmul_stream(s, imax, nitr, NULL, NULL);
+}
+
+//--------------------------------------------------------------------------------------//
+
+c_runtime_data
+c_execute_matmul_stream(int64_t s, int64_t imax, int64_t nitr, c_trial_callback callback,
+                        void* user_data)
 {
     printf("\nRunning %" PRId64 " MM on %" PRId64 " x %" PRId64 "\n", imax, s, s);
     double* a = (double*) malloc(s * s * sizeof(double));
@@ -113,20 +122,26 @@ c_execute_matmul(int64_t s, int64_t imax, int64_t nitr)
 
     mm_reset(s, a, b, c);
 
-    double base_sum = 0.0;
+    double  base_sum = 0.0;
+    int64_t nwarmup  = 0;
     // base-line and warm-up
-    for(int64_t i = 0; i < nitr; ++i)
+    for(; nwarmup < nitr; ++nwarmup)
     {
         mm_reset(s, a, b, c);
         int64_t inst_count = 0;
         for(int64_t iter = 0; iter < imax; iter++)
             inst_count += mm(s, a, b, c);
         base_sum += mm_sum(s, a);
+
+        // warm-up entries are not streamed, only polled for a stop request
+        if(callback && callback(NULL, user_data) != 0)
+            break;
     }
 
-    double inst_sum = 0.0;
+    int64_t ncomplete = 0;
+    double  inst_sum  = 0.0;
     // with instrumentation
-    for(int64_t i = 0; i < nitr; ++i)
+    for(int64_t i = 0; i < nitr && nwarmup == nitr; ++i)
     {
         mm_reset(s, a, b, c);
         double  t_beg      = wtime();
@@ -140,12 +155,27 @@ c_execute_matmul(int64_t s, int64_t imax, int64_t nitr)
         data.inst_count[i]   = inst_count;
         data.timing[i]       = t_diff;
         data.inst_per_sec[i] = ((double) inst_count) / t_diff;
+        ++ncomplete;
+
+        if(callback)
+        {
+            c_trial_record record = { i, inst_count, t_diff, data.inst_per_sec[i] };
+            if(callback(&record, user_data) != 0)
+                break;
+        }
     }
 
     free(a);
     free(b);
     free(c);
 
+    // sums are not comparable after stopping early
+    if(ncomplete < nitr)
+    {
+        data.entries = ncomplete;
+        return data;
+    }
+
     if(fabs(base_sum - inst_sum) > 1.0e-9)
         fprintf(stderr, "Error! Baseline result != instrumentation result: %f vs. %f",
                 base_sum, inst_sum);
@@ -99,10 +99,10 @@ mm_reset(int64_t s, double* a, double* b, double* c)
 //--------------------------------------------------------------------------------------//
 
 cxx_runtime_data
-cxx_execute_matmul(int64_t s, int64_t imax, int64_t nitr)
+cxx_execute_matmul(int64_t s, int64_t imax, int64_t nitr, cxx_runtime_control* ctrl,
+                   cxx_runtime_data* reference)
 {
     using dvec_t  = std::vector<double>;
-    using ivec_t  = std::vector<int64_t>;
     using entry_t = std::tuple<int64_t, int64_t, double>;
 
     printf("\nRunning %" PRId64 " MM on %" PRId64 " x %" PRId64 "\n", imax, s, s);
@@ -116,22 +116,34 @@ cxx_execute_matmul(int64_t s, int64_t imax, int64_t nitr)
 
     cxx_runtime_data data(nitr);
 
+    auto interrupted = [&]() { return ctrl && ctrl->interrupted(); };
+
+    if(reference)
+        *reference = cxx_runtime_data(nitr);
+
     double base_sum = 0.0;
     // base-line and warm-up
-    for(int64_t i = 0; i < nitr; ++i)
+    for(int64_t i = 0; i < nitr && !interrupted(); ++i)
     {
         mm_reset(s, a, b, c);
+        double  t_beg      = wtime();
         int64_t inst_count = 0;
         for(int64_t iter = 0; iter < imax; iter++)
             inst_count += mm(s, a, b, c);
+        double t_end = wtime();
         base_sum += mm_sum(s, a);
+        if(reference)
+            *reference += entry_t(i, inst_count, t_end - t_beg);
     }
 
-    double inst_sum = 0.0;
+    int64_t ncomplete = 0;
+    double  inst_sum  = 0.0;
     // with instrumentation
-    for(int64_t i = 0; i < nitr; ++i)
+    for(int64_t i = 0; i < nitr && !interrupted(); ++i)
     {
         mm_reset(s, a, b, c);
+        if(ctrl)
+            ctrl->begin(i);
         double  t_beg      = wtime();
         int64_t inst_count = 0;
         for(int64_t iter = 0; iter < imax; iter++)
@@ -140,6 +152,16 @@ cxx_execute_matmul(int64_t s, int64_t imax, int64_t nitr)
         double t_diff = t_end - t_beg;
         inst_sum += mm_sum(s, a);
         data += entry_t(i, inst_count, t_diff);
+        ++ncomplete;
+        if(ctrl)
+            ctrl->notify(cxx_trial_record(i, inst_count, t_diff, inst_count / t_diff));
+    }
+
+    if(ncomplete < nitr)
+    {
+        // sums are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
     }
 
     if(abs(base_sum - inst_sum) > 1.0e-9)
@@ -0,0 +1,271 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+// hardware counters
+#include "system.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+// a node of the randomized structure: the successor is chosen by the data
+struct chase_node
+{
+    uint32_t next[2];  // next[0] visits every node (single cycle), next[1] is random
+    uint32_t inst;     // node is instrumented
+    uint64_t value;
+};
+
+// hardware counters summed over the entries of a launch
+struct chase_counters
+{
+    int64_t value[hw_counters::nevents] = { 0, 0, 0, 0 };
+};
+
+}  // namespace
+
+//======================================================================================//
+// nodes are linked in a random single cycle (Sattolo) plus a random edge, a fraction
+// (density) of them is instrumented
+
+std::vector<chase_node>
+chase_build(int64_t nnodes, double density)
+{
+    std::mt19937_64                        rng(1779033703);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<uint32_t>                  order(nnodes);
+    std::iota(order.begin(), order.end(), 0);
+    for(int64_t i = nnodes - 1; i > 0; --i)
+        std::swap(order[i], order[rng() % i]);
+
+    std::vector<chase_node> nodes(nnodes);
+    for(int64_t i = 0; i < nnodes; ++i)
+    {
+        nodes[i].next[0] = order[i];
+        nodes[i].next[1] = static_cast<uint32_t>(rng() % nnodes);
+        nodes[i].inst    = (uniform(rng) < density) ? 1 : 0;
+        nodes[i].value   = rng();
+    }
+    return nodes;
+}
+
+//======================================================================================//
+// data-dependent work of a node, the case is effectively random
+
+uint64_t
+chase_work(const chase_node& node, uint64_t acc)
+{
+    switch(node.value & 3)
+    {
+        case 0: return acc * 3 + node.value;
+        case 1: return acc ^ (node.value >> 7);
+        case 2: return (acc << 13) | (acc >> 51);
+        default: return (acc & 4) ? acc + (node.value >> 11) : acc - node.value;
+    }
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::none>::value> = 0>
+uint64_t
+chase_visit(const chase_node& node, uint64_t acc)
+{
+    return chase_work(node, acc);
+}
+
+//======================================================================================//
+// the label is the kind of work of the node
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::inst>::value> = 0>
+uint64_t
+chase_visit(const chase_node& node, uint64_t acc)
+{
+    if(!node.inst)
+        return chase_work(node, acc);
+    int64_t label = static_cast<int64_t>(node.value & 3);
+    INSTRUMENT_CREATE(label);
+    INSTRUMENT_START(label);
+    uint64_t ret = chase_work(node, acc);
+    INSTRUMENT_STOP(label);
+    // the label is unused when the macros are empty
+    (void) label;
+    return ret;
+}
+
+//======================================================================================//
+
+template <typename _Tp>
+uint64_t
+chase_walk(const std::vector<chase_node>& nodes, int64_t nsteps, int64_t& nregions)
+{
+    uint64_t acc = 0;
+    uint32_t idx = 0;
+    nregions     = 0;
+    for(int64_t i = 0; i < nsteps; ++i)
+    {
+        const chase_node& node = nodes[idx];
+        nregions += node.inst;
+        acc = chase_visit<_Tp>(node, acc);
+        idx = node.next[(acc >> 17) & 1];
+    }
+    return acc;
+}
+
+//======================================================================================//
+
+template <typename _Tp>
+uint64_t
+launch(int64_t nitr, const std::vector<chase_node>& nodes, int64_t nsteps,
+       cxx_runtime_data& data, hw_counters& counters, chase_counters& totals,
+       int64_t& nregions, cxx_runtime_control* ctrl, int64_t& ncomplete)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    constexpr bool is_inst = std::is_same<_Tp, mode::inst>::value;
+    uint64_t       ans     = 0;
+    ncomplete              = 0;
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && is_inst)
+            ctrl->begin(i);
+        counters.start();
+        auto t_beg = wtime();
+        ans += chase_walk<_Tp>(nodes, nsteps, nregions);
+        auto t_diff = wtime() - t_beg;
+        counters.stop();
+        for(int k = 0; k < hw_counters::nevents; ++k)
+            totals.value[k] += counters.read(static_cast<hw_counters::event>(k));
+        int64_t inst_count = (is_inst) ? nregions : 0;
+        ++ncomplete;
+        data += entry_t(i, inst_count, t_diff);
+        // only the instrumented entries are streamed
+        if(ctrl && is_inst)
+            ctrl->notify(cxx_trial_record(i, inst_count, t_diff, inst_count / t_diff));
+    }
+    return ans;
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_pointer_chase(int64_t nnodes, int64_t nsteps, double density, int64_t nitr,
+                          cxx_runtime_control* ctrl, cxx_runtime_data* reference)
+{
+    if(nnodes < 2 || nnodes > UINT32_MAX || nsteps < 1)
+        throw std::runtime_error("pointer chase requires 2 <= nnodes <= 2^32 - 1 and "
+                                 "nsteps >= 1");
+    if(density < 0.0 || density > 1.0)
+        throw std::runtime_error("pointer chase requires 0 <= density <= 1");
+
+    auto             nodes = chase_build(nnodes, density);
+    hw_counters      counters;
+    chase_counters   none_totals;
+    chase_counters   inst_totals;
+    cxx_runtime_data data(nitr);
+    cxx_runtime_data none_data(nitr);
+
+    std::cout << "\nRunning " << nitr << " iterations of pointer chase(nodes = " << nnodes
+              << ", steps = " << nsteps << ", density = " << density << ")..."
+              << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline (warm-up) and instruction mode
+    //----------------------------------------------------------------------------------//
+    int64_t ncomplete = 0;
+    int64_t nregions  = 0;
+    auto    ans_none  = launch<mode::none>(nitr, nodes, nsteps, none_data, counters,
+                                       none_totals, nregions, ctrl, ncomplete);
+    auto    ans_inst  = launch<mode::inst>(nitr, nodes, nsteps, data, counters,
+                                       inst_totals, nregions, ctrl, ncomplete);
+
+    if(reference)
+        *reference = none_data;
+
+    if(ncomplete < nitr)
+    {
+        // answers are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
+    }
+
+    // we need to use these values so they don't get optimized away
+    if(ans_none != ans_inst)
+    {
+        std::stringstream ss;
+        ss << "Answer w/o instrumentation != answer w/ instrumentation : " << ans_none
+           << " vs. " << ans_inst;
+        throw std::runtime_error(ss.str());
+    }
+
+    auto&  _none  = none_data.timing;
+    double t_none = std::accumulate(_none.begin(), _none.end(), 0.0);
+    double t_inst = std::accumulate(data.timing.begin(), data.timing.end(), 0.0);
+    double _steps = static_cast<double>(nsteps) * nitr;
+    double _calls = static_cast<double>(nregions) * nitr;
+
+    data.metrics["nnodes"]            = nnodes;
+    data.metrics["nsteps"]            = nsteps;
+    data.metrics["density"]           = density;
+    data.metrics["regions"]           = nregions;
+    data.metrics["base_timing"]       = (nitr > 0) ? t_none / nitr : 0.0;
+    data.metrics["overhead_per_call"] = (_calls > 0) ? (t_inst - t_none) / _calls : 0.0;
+    data.metrics["counters"]          = counters.navailable();
+
+    // per step of the uninstrumented walk and the difference per region
+    for(int k = 0; k < hw_counters::nevents; ++k)
+    {
+        auto _event = static_cast<hw_counters::event>(k);
+        if(!counters.available(_event) || _steps == 0)
+            continue;
+        std::string _name = hw_counters::name(_event);
+        double      _diff = inst_totals.value[k] - none_totals.value[k];
+        data.metrics["base_" + _name]     = none_totals.value[k] / _steps;
+        data.metrics[_name + "_per_call"] = (_calls > 0) ? _diff / _calls : 0.0;
+    }
+    return data;
+}
+
+//======================================================================================//
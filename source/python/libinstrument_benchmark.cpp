@@ -55,12 +55,21 @@
 #include "pybind11/pytypes.h"
 #include "pybind11/stl.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "@SUBMODULE_HEADER_FILE@"
 
+#include "analysis.hpp"
 #include "instrumentation.h"
 #include "instrumentation.hpp"
+#include "process.hpp"
 
 // provides instrumentation definitions if not
 #include "fallback_inst.h"
@@ -75,6 +84,213 @@ consume_parameters(_Args&&...)
 {
 }
 
+//--------------------------------------------------------------------------------------//
+/// runs INSTRUMENT_SUSPEND() when a test leaves its scope, including by an exception,
+/// so that e.g. the timer of a sampling tool does not stay armed
+struct suspend_guard
+{
+    suspend_guard() = default;
+    ~suspend_guard() { INSTRUMENT_SUSPEND(); }
+
+    suspend_guard(const suspend_guard&) = delete;
+    suspend_guard& operator=(const suspend_guard&) = delete;
+};
+
+//--------------------------------------------------------------------------------------//
+/// adapts a cxx_runtime_control to the C streaming interface
+extern "C" int
+runtime_control_trampoline(const c_trial_record* _record, void* _ctrl)
+{
+    auto ctrl = static_cast<cxx_runtime_control*>(_ctrl);
+    // polled between the warm-up entries
+    if(!_record)
+        return (ctrl->interrupted()) ? 1 : 0;
+    auto _rec = cxx_trial_record(_record->index, _record->inst_count, _record->timing,
+                                 _record->inst_per_sec);
+    return (ctrl->notify(_rec)) ? 0 : 1;
+}
+
+//--------------------------------------------------------------------------------------//
+/// wraps a Python callable (or None) invoked with each completed entry. The GIL is
+/// acquired for the call and a return value of False stops the test
+inline cxx_runtime_control::callback_t
+make_callback(py::object func)
+{
+    if(func.is_none())
+        return cxx_runtime_control::callback_t{};
+    return [func](const cxx_trial_record& _record) {
+        py::gil_scoped_acquire acquire;
+        py::object             ret = func(_record);
+        return ret.is_none() || ret.cast<bool>();
+    };
+}
+
+//--------------------------------------------------------------------------------------//
+/// handle to a test executing on a background thread (returned by *_async). The
+/// test runs without the GIL so Python can poll, wait with a timeout, or cancel.
+/// Cancellation is cooperative: the test stops after the current timing entry and
+/// the result holds the entries completed so far.
+struct runtime_future
+{
+    using data_t     = cxx_runtime_data;
+    using control_t  = cxx_runtime_control;
+    using callback_t = control_t::callback_t;
+    using future_t   = std::shared_future<data_t>;
+
+    template <typename _Func>
+    runtime_future(_Func&& func, int64_t cpu, callback_t callback = callback_t{})
+    : control(std::make_shared<control_t>())
+    {
+        control->callback                 = callback;
+        auto                         ctrl = control;
+        std::packaged_task<data_t()> task([=]() {
+            pin_thread(cpu);
+            return func(ctrl.get());
+        });
+        result = task.get_future().share();
+        worker = std::thread(std::move(task));
+    }
+
+    ~runtime_future()
+    {
+        control->interrupt.store(true);
+        if(worker.joinable())
+        {
+            py::gil_scoped_release release;
+            worker.join();
+        }
+    }
+
+    runtime_future(const runtime_future&) = delete;
+    runtime_future& operator=(const runtime_future&) = delete;
+
+    bool done() const
+    {
+        return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // negative timeout waits indefinitely
+    bool wait(double timeout) const
+    {
+        py::gil_scoped_release release;
+        if(timeout < 0.0)
+        {
+            result.wait();
+            return true;
+        }
+        auto _dur = std::chrono::duration<double>(timeout);
+        return result.wait_for(_dur) == std::future_status::ready;
+    }
+
+    data_t* get(double timeout) const
+    {
+        if(!wait(timeout))
+        {
+            PyErr_SetString(PyExc_TimeoutError, "benchmark did not complete in time");
+            throw py::error_already_set();
+        }
+        return new data_t(result.get());
+    }
+
+    // rethrow any exception from the test if it has finished
+    void check() const
+    {
+        if(done())
+            result.get();
+    }
+
+    bool cancel()
+    {
+        bool _running = !done();
+        control->interrupt.store(true);
+        return _running;
+    }
+
+    bool cancelled() const { return control->interrupted(); }
+
+private:
+    std::shared_ptr<control_t> control;
+    future_t                   result;
+    std::thread                worker;
+};
+
+//--------------------------------------------------------------------------------------//
+/// Python iterator over the entries of a test executing on a background thread.
+/// Each entry is yielded as (index, inst_count, timing, inst_per_sec) as soon as
+/// it completes
+struct runtime_stream
+{
+    using record_t = cxx_trial_record;
+
+    struct state_t
+    {
+        bool                    finished = false;
+        std::mutex              mutex;
+        std::condition_variable cv;
+        std::deque<record_t>    records;
+    };
+
+    // marks the stream as finished when the test returns or throws
+    struct finish_guard
+    {
+        std::shared_ptr<state_t> state;
+        ~finish_guard()
+        {
+            std::unique_lock<std::mutex> _lk(state->mutex);
+            state->finished = true;
+            state->cv.notify_all();
+        }
+    };
+
+    template <typename _Func>
+    runtime_stream(_Func&& func, int64_t cpu)
+    : state(std::make_shared<state_t>())
+    {
+        auto _state    = state;
+        auto _callback = [_state](const record_t& _record) {
+            std::unique_lock<std::mutex> _lk(_state->mutex);
+            _state->records.push_back(_record);
+            _state->cv.notify_all();
+            return true;
+        };
+        auto _func = [=](cxx_runtime_control* ctrl) {
+            finish_guard _guard{ _state };
+            return func(ctrl);
+        };
+        future.reset(new runtime_future(_func, cpu, _callback));
+    }
+
+    record_t next()
+    {
+        bool     _have = false;
+        record_t _record;
+        {
+            py::gil_scoped_release       release;
+            std::unique_lock<std::mutex> _lk(state->mutex);
+            state->cv.wait(_lk,
+                           [&]() { return !state->records.empty() || state->finished; });
+            if(!state->records.empty())
+            {
+                _record = state->records.front();
+                state->records.pop_front();
+                _have = true;
+            }
+        }
+        if(!_have)
+        {
+            future->check();
+            throw py::stop_iteration();
+        }
+        return _record;
+    }
+
+    runtime_future& get_future() { return *future; }
+
+private:
+    std::shared_ptr<state_t>        state;
+    std::unique_ptr<runtime_future> future;
+};
+
 PYBIND11_MODULE(INST_MODULE_NAME, inst)
 {
     py::add_ostream_redirect(inst, "ostream_redirect");
@@ -85,8 +301,12 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
     //
     //----------------------------------------------------------------------------------//
 #if defined(USE_C)
-    auto execute_c_matmul = [](int64_t s, int64_t max, int64_t nitr) {
-        c_runtime_data ret = c_execute_matmul(s, max, nitr);
+    auto execute_c_matmul = [](int64_t s, int64_t max, int64_t nitr,
+                               cxx_runtime_control* ctrl) {
+        c_runtime_data ret =
+            (ctrl) ? c_execute_matmul_stream(s, max, nitr, &runtime_control_trampoline,
+                                             static_cast<void*>(ctrl))
+                   : c_execute_matmul(s, max, nitr);
         // convert to C++ type
         cxx_runtime_data _data(ret.entries);
         using result_t = std::tuple<int64_t, int64_t, double, double>;
@@ -104,12 +324,14 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
     //----------------------------------------------------------------------------------//
 
 #if defined(USE_CXX)
-    auto execute_cxx_matmul = [](int64_t s, int64_t max, int64_t nitr) {
-        return cxx_execute_matmul(s, max, nitr);
+    auto execute_cxx_matmul = [](int64_t s, int64_t max, int64_t nitr,
+                                 cxx_runtime_control* ctrl) {
+        return cxx_execute_matmul(s, max, nitr, ctrl);
     };
 
-    auto execute_cxx_fibonacci = [](int64_t nfib, int64_t cutoff, int64_t nitr) {
-        return cxx_execute_fibonacci(nfib, cutoff, nitr);
+    auto execute_cxx_fibonacci = [](int64_t nfib, int64_t cutoff, int64_t nitr,
+                                    cxx_runtime_control* ctrl) {
+        return cxx_execute_fibonacci(nfib, cutoff, nitr, ctrl);
     };
 
 #endif
@@ -120,8 +342,10 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
     //
     //----------------------------------------------------------------------------------//
 
-    auto execute_matmul = [&](int64_t s, int64_t max, int64_t nitr, std::string lang) {
+    auto execute_matmul = [=](int64_t s, int64_t max, int64_t nitr, std::string lang,
+                              cxx_runtime_control* ctrl) {
         INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
 
         for(auto& itr : lang)
             itr = tolower(itr);
@@ -131,14 +355,14 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
         if(lang == "c")
         {
 #if defined(USE_C)
-            _data = new cxx_runtime_data(execute_c_matmul(s, max, nitr));
+            _data = new cxx_runtime_data(execute_c_matmul(s, max, nitr, ctrl));
 #endif
         }
 
         if(lang == "cxx")
         {
 #if defined(USE_CXX)
-            _data = new cxx_runtime_data(execute_cxx_matmul(s, max, nitr));
+            _data = new cxx_runtime_data(execute_cxx_matmul(s, max, nitr, ctrl));
 #endif
         }
 
@@ -152,9 +376,10 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
     //
     //----------------------------------------------------------------------------------//
 
-    auto execute_fibonacci = [&](int64_t nfib, int64_t cutoff, int64_t nitr,
-                                 std::string lang) {
+    auto execute_fibonacci = [=](int64_t nfib, int64_t cutoff, int64_t nitr,
+                                 std::string lang, cxx_runtime_control* ctrl) {
         INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
 
         for(auto& itr : lang)
             itr = tolower(itr);
@@ -166,14 +391,15 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
 #if defined(USE_C)
             // not implemented yet
             _data = nullptr;
-            consume_parameters(nfib, cutoff, nitr);
+            consume_parameters(nfib, cutoff, nitr, ctrl);
 #endif
         }
 
         if(lang == "cxx")
         {
 #if defined(USE_CXX)
-            _data = new cxx_runtime_data(execute_cxx_fibonacci(nfib, cutoff, nitr));
+            _data =
+                new cxx_runtime_data(execute_cxx_fibonacci(nfib, cutoff, nitr, ctrl));
 #endif
         }
 
@@ -181,17 +407,781 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
         return _data;
     };
 
+    //----------------------------------------------------------------------------------//
+    //
+    // execute region tree (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_region_tree = [=](int64_t depth, int64_t fanout, int64_t work,
+                                   std::string labels, int64_t nitr,
+                                   cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        for(auto& itr : labels)
+            itr = tolower(itr);
+
+        if(labels != "same" && labels != "distinct")
+            throw std::runtime_error("region_tree labels must be 'same' or 'distinct'");
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(cxx_execute_region_tree(
+            depth, fanout, work, labels == "distinct", nitr, ctrl));
+#else
+        consume_parameters(depth, fanout, work, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute trace replay (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_trace_replay = [=](std::string path, int64_t nitr,
+                                    cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(cxx_execute_trace_replay(path, nitr, ctrl));
+#else
+        consume_parameters(path, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute function interposition (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_interpose = [=](int64_t nsymbols, int64_t ncalls, int64_t work,
+                                 int64_t nitr, cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(
+            cxx_execute_interpose(nsymbols, ncalls, work, nitr, ctrl));
+#else
+        consume_parameters(nsymbols, ncalls, work, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute exception unwinding (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_unwind = [=](int64_t nfib, int64_t cutoff, double rate, int64_t levels,
+                              int64_t nitr, cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(
+            cxx_execute_unwind(nfib, cutoff, rate, levels, nitr, ctrl));
+#else
+        consume_parameters(nfib, cutoff, rate, levels, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute first call (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_first_call = [=](int64_t nlabels, int64_t ncold, int64_t nwarm,
+                                  int64_t work, int64_t flush_bytes, int64_t nitr,
+                                  cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(cxx_execute_first_call(nlabels, ncold, nwarm, work,
+                                                            flush_bytes, nitr, ctrl));
+#else
+        consume_parameters(nlabels, ncold, nwarm, work, flush_bytes, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute label contention (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_contention = [=](int64_t nthreads, int64_t nregions, int64_t work,
+                                  double overlap, int64_t nitr,
+                                  cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(
+            cxx_execute_contention(nthreads, nregions, work, overlap, nitr, ctrl));
+#else
+        consume_parameters(nthreads, nregions, work, overlap, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute syscall I/O (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_syscall_io = [=](int64_t nops, int64_t nbytes, int64_t fsync_every,
+                                  std::string directory, int64_t nitr,
+                                  cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(
+            cxx_execute_syscall_io(nops, nbytes, fsync_every, directory, nitr, ctrl));
+#else
+        consume_parameters(nops, nbytes, fsync_every, directory, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute pointer chase (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_pointer_chase = [=](int64_t nnodes, int64_t nsteps, double density,
+                                     int64_t nitr, cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(
+            cxx_execute_pointer_chase(nnodes, nsteps, density, nitr, ctrl));
+#else
+        consume_parameters(nnodes, nsteps, density, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute thread churn (C++ only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_thread_churn = [=](int64_t nthreads, int64_t nregions, int64_t work,
+                                    int64_t nitr, cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX)
+        _data = new cxx_runtime_data(
+            cxx_execute_thread_churn(nthreads, nregions, work, nitr, ctrl));
+#else
+        consume_parameters(nthreads, nregions, work, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // execute coroutine pipeline (C++20 only)
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto execute_coroutine = [=](int64_t ntasks, int64_t nstages, int64_t work,
+                                 int64_t nthreads, int64_t nitr,
+                                 cxx_runtime_control* ctrl) {
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        cxx_runtime_data* _data = nullptr;
+#if defined(USE_CXX) && defined(USE_COROUTINES)
+        _data = new cxx_runtime_data(
+            cxx_execute_coroutine(ntasks, nstages, work, nthreads, nitr, ctrl));
+#else
+        consume_parameters(ntasks, nstages, work, nthreads, nitr, ctrl);
+#endif
+
+        // potentially return None to Python
+        return _data;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // asynchronous execution -- returns a runtime_future
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto matmul_func = [=](int64_t s, int64_t max, int64_t nitr, std::string lang) {
+        return [=](cxx_runtime_control* ctrl) {
+            std::unique_ptr<cxx_runtime_data> _data(
+                execute_matmul(s, max, nitr, lang, ctrl));
+            if(!_data)
+                throw std::runtime_error("matmul not available for language: " + lang);
+            return *_data;
+        };
+    };
+
+    auto fibonacci_func = [=](int64_t nfib, int64_t cutoff, int64_t nitr,
+                              std::string lang) {
+        return [=](cxx_runtime_control* ctrl) {
+            std::unique_ptr<cxx_runtime_data> _data(
+                execute_fibonacci(nfib, cutoff, nitr, lang, ctrl));
+            if(!_data)
+                throw std::runtime_error("fibonacci not available for language: " + lang);
+            return *_data;
+        };
+    };
+
+    auto async_matmul = [=](int64_t s, int64_t max, int64_t nitr, std::string lang,
+                            int64_t cpu, py::object callback) {
+        return new runtime_future(matmul_func(s, max, nitr, lang), cpu,
+                                  make_callback(callback));
+    };
+
+    auto async_fibonacci = [=](int64_t nfib, int64_t cutoff, int64_t nitr,
+                               std::string lang, int64_t cpu, py::object callback) {
+        return new runtime_future(fibonacci_func(nfib, cutoff, nitr, lang), cpu,
+                                  make_callback(callback));
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // streaming execution -- returns an iterator over the entries
+    //
+    //----------------------------------------------------------------------------------//
+
+    auto stream_matmul = [=](int64_t s, int64_t max, int64_t nitr, std::string lang,
+                             int64_t cpu) {
+        return new runtime_stream(matmul_func(s, max, nitr, lang), cpu);
+    };
+
+    auto stream_fibonacci = [=](int64_t nfib, int64_t cutoff, int64_t nitr,
+                                std::string lang, int64_t cpu) {
+        return new runtime_stream(fibonacci_func(nfib, cutoff, nitr, lang), cpu);
+    };
+
+    //----------------------------------------------------------------------------------//
+    //
+    // the GIL is released while the tests run so other Python threads can progress.
+    // The optional callback is invoked with each entry outside of the timed region
+    //
+    //----------------------------------------------------------------------------------//
+
+    inst.def("matmul",
+             [=](int64_t s, int64_t max, int64_t nitr, std::string lang,
+                 py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_matmul(s, max, nitr, lang, &ctrl);
+             },
+             "Execute matrix multiply test", py::arg("size") = 100,
+             py::arg("ientry") = 10000, py::arg("nitr") = 1,
+             py::arg("language") = DEFAULT_LANGUAGE, py::arg("callback") = py::none());
+
+    inst.def("fibonacci",
+             [=](int64_t nfib, int64_t cutoff, int64_t nitr, std::string lang,
+                 py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_fibonacci(nfib, cutoff, nitr, lang, &ctrl);
+             },
+             "Execute fibonacci test", py::arg("size") = 43, py::arg("cutoff") = 23,
+             py::arg("nitr") = 1, py::arg("language") = DEFAULT_LANGUAGE,
+             py::arg("callback") = py::none());
+
+    inst.def("region_tree",
+             [=](int64_t depth, int64_t fanout, int64_t work, std::string labels,
+                 int64_t nitr, py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_region_tree(depth, fanout, work, labels, nitr, &ctrl);
+             },
+             "Execute region tree test (depth levels of fanout regions, labels are "
+             "'same' or 'distinct'). Per-call overhead and memory are in metrics()",
+             py::arg("depth") = 10, py::arg("fanout") = 2, py::arg("work") = 100,
+             py::arg("labels") = "distinct", py::arg("nitr") = 1,
+             py::arg("callback") = py::none());
+
+    inst.def("trace_replay",
+             [=](std::string path, int64_t nitr, py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_trace_replay(path, nitr, &ctrl);
+             },
+             "Replay a recorded region trace (binary or CSV) with calibrated work. "
+             "The slowdown w.r.t. the uninstrumented replay is in metrics()",
+             py::arg("path"), py::arg("nitr") = 1, py::arg("callback") = py::none());
+
+    inst.def("interpose",
+             [=](int64_t nsymbols, int64_t ncalls, int64_t work, int64_t nitr) {
+                 cxx_runtime_control ctrl;
+                 py::gil_scoped_release release;
+                 return execute_interpose(nsymbols, ncalls, work, nitr, &ctrl);
+             },
+             "Execute function interposition test: calls into a shared library directly, "
+             "through LD_PRELOAD wrappers, through rewritten GOT entries and through "
+             "rewritten GOT entries which start/stop a region. Per-call costs are in "
+             "metrics()",
+             py::arg("nsymbols") = 1, py::arg("ncalls") = 1000000, py::arg("work") = 0,
+             py::arg("nitr") = 1);
+
+    inst.def("unwind",
+             [=](int64_t nfib, int64_t cutoff, double rate, int64_t levels, int64_t nitr,
+                 py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_unwind(nfib, cutoff, rate, levels, nitr, &ctrl);
+             },
+             "Execute fibonacci test where leaves throw with the given rate and the "
+             "exceptions unwind through the given number of region levels. Unwinding "
+             "cost and region depth checks are in metrics()",
+             py::arg("size") = 35, py::arg("cutoff") = 15, py::arg("rate") = 0.01,
+             py::arg("levels") = 2, py::arg("nitr") = 1,
+             py::arg("callback") = py::none());
+
+    inst.def("thread_churn",
+             [=](int64_t nthreads, int64_t nregions, int64_t work, int64_t nitr,
+                 py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_thread_churn(nthreads, nregions, work, nitr, &ctrl);
+             },
+             "Execute thread churn test (nthreads short-lived threads of nregions "
+             "regions each). Per-thread set-up/tear-down cost and memory are in "
+             "metrics()",
+             py::arg("nthreads") = 1000, py::arg("nregions") = 4, py::arg("work") = 100,
+             py::arg("nitr") = 1, py::arg("callback") = py::none());
+
+    inst.def("first_call",
+             [=](int64_t nlabels, int64_t ncold, int64_t nwarm, int64_t work,
+                 int64_t flush_bytes, int64_t nitr, py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_first_call(nlabels, ncold, nwarm, work, flush_bytes, nitr,
+                                           &ctrl);
+             },
+             "Execute first call test (nlabels new labels invoked ncold + nwarm times, "
+             "optionally flushing the caches before the cold invocations). Cold and "
+             "warm latencies and their ratio are in metrics()",
+             py::arg("nlabels") = 1000, py::arg("ncold") = 2, py::arg("nwarm") = 8,
+             py::arg("work") = 100, py::arg("flush_bytes") = 0, py::arg("nitr") = 1,
+             py::arg("callback") = py::none());
+
+    inst.def("contention",
+             [=](int64_t nthreads, int64_t nregions, int64_t work, double overlap,
+                 int64_t nitr, py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_contention(nthreads, nregions, work, overlap, nitr,
+                                           &ctrl);
+             },
+             "Execute label contention test (nthreads threads with a shared label, "
+             "private labels and a mix). Throughput per thread and the penalty of "
+             "sharing a label are in metrics()",
+             py::arg("nthreads") = 4, py::arg("nregions") = 100000,
+             py::arg("work") = 100, py::arg("overlap") = 0.25, py::arg("nitr") = 1,
+             py::arg("callback") = py::none());
+
+    inst.def("syscall_io",
+             [=](int64_t nops, int64_t nbytes, int64_t fsync_every, std::string directory,
+                 int64_t nitr, py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_syscall_io(nops, nbytes, fsync_every, directory, nitr,
+                                           &ctrl);
+             },
+             "Execute syscall I/O test (nops writes and reads of nbytes to a temporary "
+             "file, optionally with fsync). Overhead w.r.t. the syscall latency and the "
+             "context switches are in metrics()",
+             py::arg("nops") = 10000, py::arg("nbytes") = 512, py::arg("fsync_every") = 0,
+             py::arg("directory") = "", py::arg("nitr") = 1,
+             py::arg("callback") = py::none());
+
+    inst.def("pointer_chase",
+             [=](int64_t nnodes, int64_t nsteps, double density, int64_t nitr,
+                 py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_pointer_chase(nnodes, nsteps, density, nitr, &ctrl);
+             },
+             "Execute pointer chase test (randomized structure with data-dependent "
+             "branches, a fraction of the nodes instrumented). Overhead per call and "
+             "branch-miss/iTLB-miss deltas (if available) are in metrics()",
+             py::arg("nnodes") = 65536, py::arg("nsteps") = 1000000,
+             py::arg("density") = 0.1, py::arg("nitr") = 1,
+             py::arg("callback") = py::none());
+
+    inst.def("coroutine",
+             [=](int64_t ntasks, int64_t nstages, int64_t work, int64_t nthreads,
+                 int64_t nitr, py::object callback) {
+                 cxx_runtime_control ctrl;
+                 ctrl.callback = make_callback(callback);
+                 py::gil_scoped_release release;
+                 return execute_coroutine(ntasks, nstages, work, nthreads, nitr, &ctrl);
+             },
+             "Execute coroutine pipeline test (ntasks coroutines of nstages regions "
+             "which suspend halfway and resume on any of nthreads threads). Returns "
+             "None unless built with USE_COROUTINES",
+             py::arg("ntasks") = 1000, py::arg("nstages") = 4, py::arg("work") = 1000,
+             py::arg("nthreads") = 2, py::arg("nitr") = 1,
+             py::arg("callback") = py::none());
+
+    inst.def("matmul_async", async_matmul,
+             "Execute matrix multiply test on a background thread",
+             py::arg("size") = 100, py::arg("ientry") = 10000, py::arg("nitr") = 1,
+             py::arg("language") = DEFAULT_LANGUAGE, py::arg("cpu") = -1,
+             py::arg("callback") = py::none());
+
+    inst.def("fibonacci_async", async_fibonacci,
+             "Execute fibonacci test on a background thread", py::arg("size") = 43,
+             py::arg("cutoff") = 23, py::arg("nitr") = 1,
+             py::arg("language") = DEFAULT_LANGUAGE, py::arg("cpu") = -1,
+             py::arg("callback") = py::none());
+
+    inst.def("matmul_stream", stream_matmul,
+             "Iterate over the entries of a matrix multiply test as they complete",
+             py::arg("size") = 100, py::arg("ientry") = 10000, py::arg("nitr") = 1,
+             py::arg("language") = DEFAULT_LANGUAGE, py::arg("cpu") = -1);
+
+    inst.def("fibonacci_stream", stream_fibonacci,
+             "Iterate over the entries of a fibonacci test as they complete",
+             py::arg("size") = 43, py::arg("cutoff") = 23, py::arg("nitr") = 1,
+             py::arg("language") = DEFAULT_LANGUAGE, py::arg("cpu") = -1);
+
+    //----------------------------------------------------------------------------------//
+    //
+    // node-level scaling: forks nproc pinned worker processes which synchronize before
+    // every timed entry. Returns the runtime_data of each rank along with the spread
+    // of the per-rank overhead and the node-aggregate cost
+    //
+    //----------------------------------------------------------------------------------//
+
+#if defined(USE_CXX)
+    using multiprocess_func_t =
+        std::function<cxx_runtime_data(cxx_runtime_control*, cxx_runtime_data*)>;
+
+    auto execute_multiprocess = [](int64_t nproc, int64_t nitr,
+                                   std::vector<int64_t> cpus, multiprocess_func_t func) {
+        std::vector<cxx_runtime_data> _ranks;
+        std::vector<cxx_runtime_data> _bases;
+        {
+            py::gil_scoped_release release;
+            _ranks = cxx_execute_multiprocess(nproc, nitr, cpus, func, &_bases);
+        }
+
+        dvec_t   _overhead;
+        dvec_t   _runtime;
+        dvec_t   _makespan;
+        py::list _data;
+        for(size_t r = 0; r < _ranks.size(); ++r)
+        {
+            auto& itr = _ranks.at(r);
+            // instrumented minus uninstrumented mean of the same process
+            _runtime.push_back(mean_and_error(itr.timing).first);
+            _overhead.push_back(_runtime.back() -
+                                mean_and_error(_bases.at(r).timing).first);
+            for(int64_t i = 0; i < itr.entries; ++i)
+            {
+                if(static_cast<int64_t>(_makespan.size()) <= i)
+                    _makespan.push_back(0.0);
+                _makespan[i] = std::max(_makespan[i], itr.timing[i]);
+            }
+            _data.append(py::cast(new cxx_runtime_data(itr),
+                                  py::return_value_policy::take_ownership));
+        }
+
+        double _sum = 0.0;
+        for(const auto& itr : _overhead)
+            _sum += itr;
+        // standard error -> standard deviation of the per-rank overhead
+        auto _mean = mean_and_error(_overhead);
+        auto _sdev = _mean.second * std::sqrt(static_cast<double>(_overhead.size()));
+
+        py::dict _ret;
+        _ret["nproc"]     = nproc;
+        _ret["ranks"]     = _data;
+        _ret["runtime"]   = _runtime;
+        _ret["overhead"]  = _overhead;
+        _ret["min"]       = *std::min_element(_overhead.begin(), _overhead.end());
+        _ret["max"]       = *std::max_element(_overhead.begin(), _overhead.end());
+        _ret["stdev"]     = _sdev;
+        _ret["aggregate"] = _sum;
+        _ret["makespan"]  = mean_and_error(_makespan).first;
+        return _ret;
+    };
+
+    inst.def("matmul_multiprocess",
+             [=](int64_t nproc, int64_t s, int64_t max, int64_t nitr,
+                 std::vector<int64_t> cpus) {
+                 return execute_multiprocess(
+                     nproc, nitr, cpus,
+                     [=](cxx_runtime_control* ctrl, cxx_runtime_data* reference) {
+                         return cxx_execute_matmul(s, max, nitr, ctrl, reference);
+                     });
+             },
+             "Execute the C++ matrix multiply test in forked, pinned worker processes",
+             py::arg("nproc") = 2, py::arg("size") = 100, py::arg("ientry") = 10000,
+             py::arg("nitr") = 1, py::arg("cpus") = std::vector<int64_t>{});
+
+    inst.def("fibonacci_multiprocess",
+             [=](int64_t nproc, int64_t nfib, int64_t cutoff, int64_t nitr,
+                 std::vector<int64_t> cpus) {
+                 return execute_multiprocess(
+                     nproc, nitr, cpus,
+                     [=](cxx_runtime_control* ctrl, cxx_runtime_data* reference) {
+                         return cxx_execute_fibonacci(nfib, cutoff, nitr, ctrl,
+                                                      reference);
+                     });
+             },
+             "Execute the C++ fibonacci test in forked, pinned worker processes",
+             py::arg("nproc") = 2, py::arg("size") = 43, py::arg("cutoff") = 23,
+             py::arg("nitr") = 1, py::arg("cpus") = std::vector<int64_t>{});
+#endif
+
+    //----------------------------------------------------------------------------------//
+    //
+    // trial isolation: every entry runs in a freshly forked process so the state of the
+    // tool does not accumulate across entries. The child inherits the state of this
+    // process so run these before any other test of the submodule
+    //
     //----------------------------------------------------------------------------------//
 
-    inst.def("matmul", execute_matmul, "Execute matrix multiply test",
+    using isolated_func_t = std::function<cxx_runtime_data(cxx_runtime_control*)>;
+
+    auto execute_isolated = [](int64_t nitr, isolated_func_t func) {
+        cxx_runtime_data _data(nitr);
+        {
+            py::gil_scoped_release release;
+            for(int64_t i = 0; i < nitr; ++i)
+            {
+                auto _trial = cxx_execute_forked<process_record>([&]() {
+                    auto           _ret = func(nullptr);
+                    process_record _record;
+                    _record.inst_count = _ret.inst_count.at(0);
+                    _record.timing     = _ret.timing.at(0);
+                    _record.complete   = 1;
+                    return _record;
+                });
+                _data += cxx_trial_record(i, _trial.inst_count, _trial.timing,
+                                          _trial.inst_count / _trial.timing);
+            }
+        }
+        _data.metrics["isolated"] = 1;
+        return _data;
+    };
+
+    inst.def("matmul_isolated",
+             [=](int64_t s, int64_t max, int64_t nitr, std::string lang) {
+                 return execute_isolated(nitr, matmul_func(s, max, 1, lang));
+             },
+             "Execute matrix multiply test with every entry in a forked process",
              py::arg("size") = 100, py::arg("ientry") = 10000, py::arg("nitr") = 1,
              py::arg("language") = DEFAULT_LANGUAGE);
 
-    inst.def("fibonacci", execute_fibonacci, "Execute fibonacci test",
+    inst.def("fibonacci_isolated",
+             [=](int64_t nfib, int64_t cutoff, int64_t nitr, std::string lang) {
+                 return execute_isolated(nitr, fibonacci_func(nfib, cutoff, 1, lang));
+             },
+             "Execute fibonacci test with every entry in a forked process",
              py::arg("size") = 43, py::arg("cutoff") = 23, py::arg("nitr") = 1,
              py::arg("language") = DEFAULT_LANGUAGE);
 
     //----------------------------------------------------------------------------------//
+    //
+    // tool lifecycle: only valid in a fresh interpreter (see lifecycle.py), which times
+    // INSTRUMENT_CONFIGURE, the first region, the remaining regions and
+    // INSTRUMENT_FINALIZE, writes the timings to path as JSON and then exits the process
+    // without finalizing python so that only the exit handlers of the tool run
+    //
+    //----------------------------------------------------------------------------------//
+
+#if defined(USE_CXX)
+    auto execute_lifecycle = [](int64_t nregions, std::string path) {
+        auto  _data = cxx_execute_lifecycle(nregions);
+        FILE* _file = fopen(path.c_str(), "w");
+        if(!_file)
+            throw std::runtime_error("lifecycle: unable to open " + path);
+        fprintf(_file,
+                "{\"nregions\": %" PRId64 ", \"configure\": %.9e, "
+                "\"first_region\": %.9e, \"regions\": %.9e, \"finalize\": %.9e, "
+                "\"exit_begin\": %.9f}\n",
+                _data.nregions, _data.configure, _data.first_region, _data.regions,
+                _data.finalize, _data.exit_begin);
+        fclose(_file);
+        fflush(stdout);
+        fflush(stderr);
+        exit(0);
+    };
+
+    inst.def("lifecycle_probe", execute_lifecycle,
+             "Time configure, first region, regions and finalize of the tool, write them "
+             "to path and exit the process (use lifecycle.measure instead)",
+             py::arg("nregions"), py::arg("path"));
+#endif
+
+    inst.def("finalize", []() { INSTRUMENT_FINALIZE(); },
+             "Finalize the tool (e.g. write output) after all tests have run");
+
+    //----------------------------------------------------------------------------------//
+    //
+    // language boundary: python calls a native function per region (see boundary.py)
+    //
+    //----------------------------------------------------------------------------------//
+
+    inst.def("configure", []() { INSTRUMENT_CONFIGURE(); },
+             "Configure the tool before a test driven from python");
+    inst.def("suspend", []() { INSTRUMENT_SUSPEND(); },
+             "Suspend the tool after a test driven from python");
+
+#if defined(USE_CXX)
+    inst.def("region", &cxx_boundary_region,
+             "Execute one instrumented region of `work` iterations (one call per region)",
+             py::arg("label"), py::arg("work") = 100);
+    inst.def("region_none", &cxx_boundary_region_none,
+             "Execute the work of region() without instrumentation", py::arg("label"),
+             py::arg("work") = 100);
+    inst.def("region_batch",
+             [](int64_t nregions, int64_t work, bool instrument) {
+                 return (instrument) ? cxx_boundary_batch(nregions, work)
+                                     : cxx_boundary_batch_none(nregions, work);
+             },
+             "Execute region() with labels 0 ... nregions - 1 in a native loop and "
+             "return the sum modulo 2^64",
+             py::arg("nregions"), py::arg("work") = 100, py::arg("instrument") = true);
+#endif
+
+    //----------------------------------------------------------------------------------//
+    //
+    // overhead model: runs a C++ test at several instrumentation densities and fits
+    //
+    //      t_inst - t_none = perturbation + n_calls * c_direct
+    //
+    // where t_none is the uninstrumented timing of the same configuration. c_direct is
+    // the per-call cost of the tool and perturbation is the density-independent
+    // indirect cost (e.g. lost inlining, cache/TLB pollution)
+    //
+    //----------------------------------------------------------------------------------//
+
+#if defined(USE_CXX)
+    auto overhead_model = [](std::string kernel, int64_t size,
+                             std::vector<int64_t> densities, int64_t nitr,
+                             int64_t ientry) {
+        for(auto& itr : kernel)
+            itr = tolower(itr);
+
+        if(kernel != "fibonacci" && kernel != "matmul")
+            throw std::runtime_error("overhead_model kernel must be fibonacci or matmul");
+
+        INSTRUMENT_CONFIGURE();
+        suspend_guard _suspend;
+
+        dvec_t   x;
+        dvec_t   y;
+        py::list points;
+        for(const auto& density : densities)
+        {
+            cxx_runtime_data _inst;
+            cxx_runtime_data _none;
+            {
+                py::gil_scoped_release release;
+                // fibonacci: density is the cutoff, matmul: density is the matrix size
+                if(kernel == "fibonacci")
+                    _inst = cxx_execute_fibonacci(size, density, nitr, nullptr, &_none);
+                else
+                    _inst = cxx_execute_matmul(density, ientry, nitr, nullptr, &_none);
+            }
+            auto _base = mean_and_error(_none.timing);
+            auto _time = mean_and_error(_inst.timing);
+            for(int64_t i = 0; i < _inst.entries; ++i)
+            {
+                x.push_back(_inst.inst_count[i]);
+                y.push_back(_inst.timing[i] - _base.first);
+            }
+            py::dict _point;
+            _point["density"]    = density;
+            _point["n_calls"]    = (_inst.entries > 0) ? _inst.inst_count[0] : 0;
+            _point["base"]       = _base.first;
+            _point["base_err"]   = _base.second;
+            _point["timing"]     = _time.first;
+            _point["timing_err"] = _time.second;
+            points.append(_point);
+        }
+
+        linear_fit _fit(x, y);
+        py::dict   _ret;
+        _ret["kernel"]           = kernel;
+        _ret["c_direct"]         = _fit.slope;
+        _ret["c_direct_err"]     = _fit.slope_err;
+        _ret["perturbation"]     = _fit.intercept;
+        _ret["perturbation_err"] = _fit.intercept_err;
+        _ret["r2"]               = _fit.r2;
+        _ret["residual"]         = _fit.residual;
+        _ret["npoints"]          = _fit.npoints;
+        _ret["points"]           = points;
+        return _ret;
+    };
+
+    inst.def("overhead_model", overhead_model,
+             "Fit per-call cost and perturbation across instrumentation densities "
+             "(fibonacci: densities are cutoffs, matmul: densities are matrix sizes)",
+             py::arg("kernel") = "fibonacci", py::arg("size") = 43,
+             py::arg("densities") = std::vector<int64_t>({ 19, 21, 23, 25, 27 }),
+             py::arg("nitr") = 5, py::arg("ientry") = 100);
+#endif
+
+    //----------------------------------------------------------------------------------//
 
 #if defined(BUILD_RUNTIME_DATA_BINDINGS)
     auto overhead = [](cxx_runtime_data* current, cxx_runtime_data* baseline) -> dvec_t {
@@ -210,6 +1200,33 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
         return overhead;
     };
 
+    // fits the overhead of each entry against the entry index. A significant slope
+    // means the cost of the tool changes as its state accumulates
+    auto drift = [overhead](cxx_runtime_data* current, cxx_runtime_data* baseline) {
+        dvec_t _y = overhead(current, baseline);
+        dvec_t _x;
+        for(uint64_t i = 0; i < _y.size(); ++i)
+            _x.push_back(i);
+
+        linear_fit _fit(_x, _y);
+        double     _span = (_y.size() > 1) ? (_y.size() - 1) : 0.0;
+
+        py::dict _ret;
+        _ret["slope"]         = _fit.slope;
+        _ret["slope_err"]     = _fit.slope_err;
+        _ret["intercept"]     = _fit.intercept;
+        _ret["intercept_err"] = _fit.intercept_err;
+        _ret["r2"]            = _fit.r2;
+        _ret["npoints"]       = _fit.npoints;
+        _ret["first"]         = _fit.intercept;
+        _ret["last"]          = _fit.intercept + _fit.slope * _span;
+        // fitted change over all entries relative to the fitted first entry
+        _ret["relative"] = (_fit.intercept != 0.0)
+                               ? (_fit.slope * _span / std::fabs(_fit.intercept))
+                               : std::numeric_limits<double>::quiet_NaN();
+        return _ret;
+    };
+
     py::class_<cxx_runtime_data> runtime_data(inst, "runtime_data");
     runtime_data.def(py::init<>(), "construct runtime_data");
     runtime_data.def("entries", [](cxx_runtime_data* d) { return d->entries; },
@@ -220,7 +1237,41 @@ PYBIND11_MODULE(INST_MODULE_NAME, inst)
                      "Get the timing entries");
     runtime_data.def("inst_per_sec", [](cxx_runtime_data* d) { return d->inst_per_sec; },
                      "Get instructions-per-second");
+    runtime_data.def("metrics", [](cxx_runtime_data* d) { return d->metrics; },
+                     "Additional quantities of the test (e.g. memory)");
     runtime_data.def("overhead", overhead, "Compute the overhead w.r.t. a baseline",
                      py::arg("baseline") = nullptr);
+    runtime_data.def("drift", drift,
+                     "Fit the overhead w.r.t. a baseline against the entry index",
+                     py::arg("baseline") = nullptr);
+
+    py::class_<runtime_future> future(inst, "runtime_future");
+    future.def("done", &runtime_future::done, "Whether the test has finished");
+    future.def("wait", &runtime_future::wait,
+               "Wait for the test to finish, returns False on timeout",
+               py::arg("timeout") = -1.0);
+    future.def("result", &runtime_future::get,
+               "Get the runtime_data (raises TimeoutError on timeout)",
+               py::arg("timeout") = -1.0);
+    future.def("cancel", &runtime_future::cancel,
+               "Stop the test after the current entry, returns True if it was running");
+    future.def("cancelled", &runtime_future::cancelled,
+               "Whether cancellation was requested");
+
+    py::class_<runtime_stream> stream(inst, "runtime_stream");
+    stream.def("__iter__", [](runtime_stream& s) -> runtime_stream& { return s; },
+               py::return_value_policy::reference_internal);
+    stream.def("__next__", &runtime_stream::next,
+               "Wait for the next (index, inst_count, timing, inst_per_sec) entry");
+    stream.def("done", [](runtime_stream& s) { return s.get_future().done(); },
+               "Whether the test has finished");
+    stream.def("result",
+               [](runtime_stream& s, double timeout) {
+                   return s.get_future().get(timeout);
+               },
+               "Get the runtime_data (raises TimeoutError on timeout)",
+               py::arg("timeout") = -1.0);
+    stream.def("cancel", [](runtime_stream& s) { return s.get_future().cancel(); },
+               "Stop the test after the current entry");
 #endif
 }
@@ -0,0 +1,215 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+// memory usage
+#include "system.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+struct tree_config
+{
+    int64_t depth;
+    int64_t fanout;
+    int64_t work;
+    bool    distinct;
+    // label of each region (level * fanout + i), built before the timed entries
+    std::vector<const char*> labels;
+};
+
+}  // namespace
+
+//======================================================================================//
+
+template <typename _Tp>
+uint64_t
+tree_level(int64_t level, const tree_config& cfg);
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::none>::value> = 0>
+uint64_t
+tree_region(const char*, int64_t level, bool recurse, const tree_config& cfg)
+{
+    return (recurse) ? tree_level<_Tp>(level + 1, cfg) : busy_work(level, cfg.work);
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::inst>::value> = 0>
+uint64_t
+tree_region(const char* label, int64_t level, bool recurse, const tree_config& cfg)
+{
+    INSTRUMENT_CREATE_LABEL(label);
+    INSTRUMENT_START_LABEL(label);
+    uint64_t ret =
+        (recurse) ? tree_level<_Tp>(level + 1, cfg) : busy_work(level, cfg.work);
+    INSTRUMENT_STOP_LABEL(label);
+    // the label is unused when the macros are empty
+    (void) label;
+    return ret;
+}
+
+//======================================================================================//
+// the last region of every level (except the deepest) contains the next level
+template <typename _Tp>
+uint64_t
+tree_level(int64_t level, const tree_config& cfg)
+{
+    uint64_t ret = 0;
+    for(int64_t i = 0; i < cfg.fanout; ++i)
+    {
+        bool recurse = (i + 1 == cfg.fanout) && (level + 1 < cfg.depth);
+        ret += tree_region<_Tp>(cfg.labels[level * cfg.fanout + i], level, recurse, cfg);
+    }
+    return ret;
+}
+
+//======================================================================================//
+
+template <typename _Tp>
+uint64_t
+launch(int64_t nitr, const tree_config& cfg, cxx_runtime_data& data,
+       cxx_runtime_control* ctrl, int64_t& ncomplete)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    constexpr bool is_inst    = std::is_same<_Tp, mode::inst>::value;
+    int64_t        inst_count = (is_inst) ? (cfg.depth * cfg.fanout) : 0;
+    uint64_t       ans        = 0;
+    ncomplete                 = 0;
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && is_inst)
+            ctrl->begin(i);
+        auto     t_beg  = wtime();
+        uint64_t ret    = tree_level<_Tp>(0, cfg);
+        auto     t_end  = wtime();
+        auto     t_diff = t_end - t_beg;
+        ans += ret;
+        ++ncomplete;
+        data += entry_t(i, inst_count, t_diff);
+        // only the instrumented entries are streamed
+        if(ctrl && is_inst)
+            ctrl->notify(cxx_trial_record(i, inst_count, t_diff, inst_count / t_diff));
+    }
+    return ans;
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_region_tree(int64_t depth, int64_t fanout, int64_t work, bool distinct,
+                        int64_t nitr, cxx_runtime_control* ctrl,
+                        cxx_runtime_data* reference)
+{
+    if(depth < 1 || fanout < 1)
+        throw std::runtime_error("region tree requires depth >= 1 and fanout >= 1");
+
+    tree_config cfg = { depth, fanout, work, distinct, {} };
+    for(int64_t i = 0; i < depth * fanout; ++i)
+    {
+        std::stringstream ss;
+        ss << "tree";
+        if(distinct)
+            ss << "_" << (i / fanout) << "_" << (i % fanout);
+        cfg.labels.push_back(persistent_label(ss.str()));
+    }
+
+    cxx_runtime_data data(nitr);
+    cxx_runtime_data none_data(nitr);
+
+    std::cout << "\nRunning " << nitr << " iterations of region tree(depth = " << depth
+              << ", fanout = " << fanout << ", work = " << work << ", labels = "
+              << ((distinct) ? "distinct" : "same") << ")..." << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline (warm-up) and instruction mode
+    //----------------------------------------------------------------------------------//
+    int64_t ncomplete = 0;
+    auto    ans_none  = launch<mode::none>(nitr, cfg, none_data, ctrl, ncomplete);
+
+    auto rss_beg  = current_rss();
+    auto ans_inst = launch<mode::inst>(nitr, cfg, data, ctrl, ncomplete);
+    auto rss_end  = current_rss();
+
+    if(reference)
+        *reference = none_data;
+
+    if(ncomplete < nitr)
+    {
+        // answers are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
+    }
+
+    // we need to use these values so they don't get optimized away
+    if(ans_none != ans_inst)
+    {
+        std::stringstream ss;
+        ss << "Answer w/o instrumentation != answer w/ instrumentation : " << ans_none
+           << " vs. " << ans_inst;
+        throw std::runtime_error(ss.str());
+    }
+
+    auto&  _none  = none_data.timing;
+    double t_none = std::accumulate(_none.begin(), _none.end(), 0.0);
+    double t_inst = std::accumulate(data.timing.begin(), data.timing.end(), 0.0);
+    double ncalls = static_cast<double>(depth * fanout * nitr);
+
+    data.metrics["depth"]             = depth;
+    data.metrics["fanout"]            = fanout;
+    data.metrics["work"]              = work;
+    data.metrics["distinct"]          = (distinct) ? 1 : 0;
+    data.metrics["regions"]           = depth * fanout;
+    data.metrics["base_timing"]       = (nitr > 0) ? t_none / nitr : 0.0;
+    data.metrics["overhead_per_call"] = (nitr > 0) ? (t_inst - t_none) / ncalls : 0.0;
+    data.metrics["rss_before"]        = rss_beg;
+    data.metrics["rss_after"]         = rss_end;
+    data.metrics["rss_delta"]         = rss_end - rss_beg;
+    data.metrics["peak_rss"]          = peak_rss();
+    return data;
+}
+
+//======================================================================================//
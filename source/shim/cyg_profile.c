@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Shim for the compiler-inserted instrumentation (-finstrument-functions) of the tests.
+//
+// The hooks are compiled into the library of the submodule without -finstrument-functions
+// and with hidden visibility so every submodule loaded in the same process binds to its
+// own hooks instead of the no-op hooks of libc. The visibility attribute is ignored for
+// these builtin declarations in C++ so it is set in the symbol table directly.
+//
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+
+#define INST_CYG_HOOK __attribute__((no_instrument_function))
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+    INST_CYG_HOOK void __cyg_profile_func_enter(void* this_fn, void* call_site);
+    INST_CYG_HOOK void __cyg_profile_func_exit(void* this_fn, void* call_site);
+
+    //--------------------------------------------------------------------------------------//
+
+    INST_CYG_HOOK void __cyg_profile_func_enter(void* this_fn, void* call_site)
+    {
+        (void) this_fn;
+        (void) call_site;
+        INSTRUMENT_ENTER(this_fn);
+    }
+
+    //--------------------------------------------------------------------------------------//
+
+    INST_CYG_HOOK void __cyg_profile_func_exit(void* this_fn, void* call_site)
+    {
+        (void) this_fn;
+        (void) call_site;
+        INSTRUMENT_EXIT(this_fn);
+    }
+
+#if defined(__cplusplus)
+}
+#endif
+
+#if defined(__ELF__)
+__asm__(".hidden __cyg_profile_func_enter");
+__asm__(".hidden __cyg_profile_func_exit");
+#endif
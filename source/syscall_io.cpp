@@ -0,0 +1,349 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+// context switches
+#include "system.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+// labels of the regions around each kind of operation
+enum : int64_t
+{
+    io_write = 0,
+    io_read,
+    io_fsync,
+    io_count
+};
+
+struct syscall_config
+{
+    int64_t nops;         // write + read operations per entry
+    int64_t nbytes;       // bytes per write and read
+    int64_t fsync_every;  // fsync after every n-th write (0 = never)
+    int64_t nblocks;      // blocks of nbytes in the file, cycled through
+};
+
+// time spent in each kind of operation and the number of operations
+struct syscall_totals
+{
+    double  elapsed[io_count] = { 0.0, 0.0, 0.0 };
+    int64_t count[io_count]   = { 0, 0, 0 };
+    int64_t voluntary         = 0;
+    int64_t involuntary       = 0;
+};
+
+// temporary file, removed when closed
+class temp_file
+{
+public:
+    explicit temp_file(const std::string& directory)
+    {
+        std::string _path = directory + "/inst-bench-io-XXXXXX";
+        m_path            = std::vector<char>(_path.begin(), _path.end());
+        m_path.push_back('\0');
+        m_fd = mkstemp(m_path.data());
+        if(m_fd < 0)
+        {
+            std::stringstream ss;
+            ss << "Unable to create a file in '" << directory
+               << "' : " << strerror(errno);
+            throw std::runtime_error(ss.str());
+        }
+    }
+
+    ~temp_file()
+    {
+        close(m_fd);
+        unlink(m_path.data());
+    }
+
+    temp_file(const temp_file&) = delete;
+    temp_file& operator=(const temp_file&) = delete;
+
+    int         fd() const { return m_fd; }
+    std::string path() const { return std::string(m_path.data()); }
+
+private:
+    int               m_fd = -1;
+    std::vector<char> m_path;
+};
+
+}  // namespace
+
+//======================================================================================//
+// prefer a tmpfs (no device latency) and fall back to the temporary directory
+
+std::string
+syscall_directory(const std::string& directory)
+{
+    if(!directory.empty())
+        return directory;
+    struct stat _stat;
+    if(stat("/dev/shm", &_stat) == 0 && S_ISDIR(_stat.st_mode) &&
+       access("/dev/shm", W_OK) == 0)
+        return "/dev/shm";
+    const char* _tmp = getenv("TMPDIR");
+    return (_tmp && strlen(_tmp) > 0) ? std::string(_tmp) : std::string("/tmp");
+}
+
+//======================================================================================//
+
+void
+syscall_check(ssize_t ret, size_t expected, const char* op)
+{
+    if(ret != static_cast<ssize_t>(expected))
+    {
+        std::stringstream ss;
+        ss << op << " failed : " << ((ret < 0) ? strerror(errno) : "short transfer");
+        throw std::runtime_error(ss.str());
+    }
+}
+
+//======================================================================================//
+// the operations, the data read is summed to check the answers
+
+uint64_t
+syscall_op(int64_t op, int fd, std::vector<uint8_t>& buffer, int64_t offset)
+{
+    switch(op)
+    {
+        case io_write:
+            syscall_check(pwrite(fd, buffer.data(), buffer.size(), offset), buffer.size(),
+                          "pwrite");
+            return 0;
+        case io_read:
+        {
+            syscall_check(pread(fd, buffer.data(), buffer.size(), offset), buffer.size(),
+                          "pread");
+            uint64_t _sum = 0;
+            for(size_t i = 0; i < buffer.size(); i += 64)
+                _sum += buffer[i];
+            return _sum;
+        }
+        case io_fsync:
+            syscall_check(fsync(fd), 0, "fsync");
+            return 0;
+    }
+    return 0;
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::none>::value> = 0>
+uint64_t
+syscall_region(int64_t op, int fd, std::vector<uint8_t>& buffer, int64_t offset)
+{
+    return syscall_op(op, fd, buffer, offset);
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::inst>::value> = 0>
+uint64_t
+syscall_region(int64_t op, int fd, std::vector<uint8_t>& buffer, int64_t offset)
+{
+    INSTRUMENT_CREATE(op);
+    INSTRUMENT_START(op);
+    uint64_t ret = syscall_op(op, fd, buffer, offset);
+    INSTRUMENT_STOP(op);
+    return ret;
+}
+
+//======================================================================================//
+// every operation writes a block of the file and reads it back (from the page cache)
+
+template <typename _Tp>
+uint64_t
+launch(int64_t nitr, const syscall_config& cfg, int fd, cxx_runtime_data& data,
+       syscall_totals& totals, cxx_runtime_control* ctrl, int64_t& ncomplete)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    // a write and a read per operation and the fsyncs
+    int64_t nregions = 2 * cfg.nops;
+    if(cfg.fsync_every > 0)
+        nregions += cfg.nops / cfg.fsync_every;
+
+    constexpr bool       is_inst    = std::is_same<_Tp, mode::inst>::value;
+    int64_t              inst_count = (is_inst) ? nregions : 0;
+    uint64_t             ans        = 0;
+    std::vector<uint8_t> buffer(cfg.nbytes, 0);
+    ncomplete = 0;
+
+    auto _csw_beg = context_switches();
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && is_inst)
+            ctrl->begin(i);
+        double t_total = 0.0;
+        for(int64_t j = 0; j < cfg.nops; ++j)
+        {
+            int64_t _offset = (j % cfg.nblocks) * cfg.nbytes;
+            int64_t _ops[]  = { io_write, io_read, io_fsync };
+            int64_t _nops =
+                (cfg.fsync_every > 0 && (j + 1) % cfg.fsync_every == 0) ? 3 : 2;
+            memset(buffer.data(), static_cast<int>((i + j) & 0xff), buffer.size());
+            for(int64_t k = 0; k < _nops; ++k)
+            {
+                auto t_beg = wtime();
+                ans += syscall_region<_Tp>(_ops[k], fd, buffer, _offset);
+                auto t_diff = wtime() - t_beg;
+                t_total += t_diff;
+                totals.elapsed[_ops[k]] += t_diff;
+                totals.count[_ops[k]] += 1;
+            }
+        }
+        ++ncomplete;
+        data += entry_t(i, inst_count, t_total);
+        // only the instrumented entries are streamed
+        if(ctrl && is_inst)
+            ctrl->notify(cxx_trial_record(i, inst_count, t_total, inst_count / t_total));
+    }
+    auto _csw_end = context_switches();
+    totals.voluntary += _csw_end.first - _csw_beg.first;
+    totals.involuntary += _csw_end.second - _csw_beg.second;
+    return ans;
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_syscall_io(int64_t nops, int64_t nbytes, int64_t fsync_every,
+                       const std::string& directory, int64_t nitr,
+                       cxx_runtime_control* ctrl, cxx_runtime_data* reference)
+{
+    if(nops < 1 || nbytes < 1)
+        throw std::runtime_error("syscall I/O requires nops >= 1 and nbytes >= 1");
+
+    // the file is at most 1 MB (or one block) so the reads hit the page cache
+    int64_t          nblocks = std::max<int64_t>((1 << 20) / nbytes, 1);
+    syscall_config   cfg     = { nops, nbytes, fsync_every, std::min(nblocks, nops) };
+    syscall_totals   none_totals;
+    syscall_totals   inst_totals;
+    temp_file        file(syscall_directory(directory));
+    cxx_runtime_data data(nitr);
+    cxx_runtime_data none_data(nitr);
+
+    std::cout << "\nRunning " << nitr << " iterations of syscall I/O(ops = " << nops
+              << ", bytes = " << nbytes << ", fsync every = " << fsync_every
+              << ", file = " << file.path() << ")..." << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline (warm-up) and instruction mode
+    //----------------------------------------------------------------------------------//
+    int64_t ncomplete = 0;
+    auto    ans_none =
+        launch<mode::none>(nitr, cfg, file.fd(), none_data, none_totals, ctrl, ncomplete);
+    auto ans_inst =
+        launch<mode::inst>(nitr, cfg, file.fd(), data, inst_totals, ctrl, ncomplete);
+
+    if(reference)
+        *reference = none_data;
+
+    if(ncomplete < nitr)
+    {
+        // answers are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
+    }
+
+    // we need to use these values so they don't get optimized away
+    if(ans_none != ans_inst)
+    {
+        std::stringstream ss;
+        ss << "Answer w/o instrumentation != answer w/ instrumentation : " << ans_none
+           << " vs. " << ans_inst;
+        throw std::runtime_error(ss.str());
+    }
+
+    const char* names[] = { "write", "read", "fsync" };
+    double      t_none  = 0.0;
+    double      t_inst  = 0.0;
+    int64_t     ncalls  = 0;
+    for(int64_t k = 0; k < io_count; ++k)
+    {
+        int64_t _n = none_totals.count[k];
+        double  _l = (_n > 0) ? none_totals.elapsed[k] / _n : 0.0;
+        double  _o = (_n > 0) ? (inst_totals.elapsed[k] - none_totals.elapsed[k]) / _n
+                             : 0.0;
+        data.metrics[std::string("latency_") + names[k]]  = _l;
+        data.metrics[std::string("overhead_") + names[k]] = _o;
+        t_none += none_totals.elapsed[k];
+        t_inst += inst_totals.elapsed[k];
+        ncalls += _n;
+    }
+
+    double _latency = (ncalls > 0) ? t_none / ncalls : 0.0;
+    double _over    = (ncalls > 0) ? (t_inst - t_none) / ncalls : 0.0;
+    double _per     = (nitr > 0) ? 1.0 / nitr : 0.0;
+
+    // context switches of the process (including the threads of the tool), reported
+    // per entry
+    int64_t _csw_inst = inst_totals.voluntary + inst_totals.involuntary;
+    int64_t _csw_none = none_totals.voluntary + none_totals.involuntary;
+
+    data.metrics["nops"]                 = nops;
+    data.metrics["nbytes"]               = nbytes;
+    data.metrics["fsync_every"]          = fsync_every;
+    data.metrics["syscall_latency"]      = _latency;
+    data.metrics["overhead_per_call"]    = _over;
+    data.metrics["overhead_relative"]    = (_latency > 0.0) ? _over / _latency : 0.0;
+    data.metrics["voluntary_csw"]        = inst_totals.voluntary * _per;
+    data.metrics["involuntary_csw"]      = inst_totals.involuntary * _per;
+    data.metrics["base_voluntary_csw"]   = none_totals.voluntary * _per;
+    data.metrics["base_involuntary_csw"] = none_totals.involuntary * _per;
+    data.metrics["csw_delta"]            = (_csw_inst - _csw_none) * _per;
+    return data;
+}
+
+//======================================================================================//
@@ -0,0 +1,251 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+// memory usage
+#include "system.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+struct churn_config
+{
+    int64_t nthreads;
+    int64_t nregions;
+    int64_t work;
+};
+
+// time-stamps of one thread lifetime
+struct churn_times
+{
+    double   spawn  = 0.0;  // before the thread is created
+    double   entry  = 0.0;  // first statement of the thread
+    double   first  = 0.0;  // end of the first region
+    double   exit   = 0.0;  // end of the last region
+    double   joined = 0.0;  // join returned (thread-local storage destroyed)
+    uint64_t answer = 0;
+};
+
+// sums of the phases of every thread lifetime
+struct churn_totals
+{
+    double create   = 0.0;
+    double first    = 0.0;
+    double rest     = 0.0;
+    double teardown = 0.0;
+
+    churn_totals& operator+=(const churn_times& rhs)
+    {
+        create += rhs.entry - rhs.spawn;
+        first += rhs.first - rhs.entry;
+        rest += rhs.exit - rhs.first;
+        teardown += rhs.joined - rhs.exit;
+        return *this;
+    }
+};
+
+}  // namespace
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::none>::value> = 0>
+uint64_t
+churn_region(int64_t label, const churn_config& cfg)
+{
+    return busy_work(label, cfg.work);
+}
+
+//======================================================================================//
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::inst>::value> = 0>
+uint64_t
+churn_region(int64_t label, const churn_config& cfg)
+{
+    INSTRUMENT_CREATE(label);
+    INSTRUMENT_START(label);
+    uint64_t ret = busy_work(label, cfg.work);
+    INSTRUMENT_STOP(label);
+    return ret;
+}
+
+//======================================================================================//
+// body of a short-lived thread: the first region is timed separately since that is
+// where most tools allocate and register the storage of the thread
+
+template <typename _Tp>
+void
+churn_thread(const churn_config& cfg, churn_times& times)
+{
+    times.entry  = wtime();
+    uint64_t ans = churn_region<_Tp>(0, cfg);
+    times.first  = wtime();
+    for(int64_t i = 1; i < cfg.nregions; ++i)
+        ans += churn_region<_Tp>(i, cfg);
+    times.exit   = wtime();
+    times.answer = ans;
+}
+
+//======================================================================================//
+// one thread is alive at a time so the phases of every lifetime are not overlapped
+
+template <typename _Tp>
+uint64_t
+launch(int64_t nitr, const churn_config& cfg, cxx_runtime_data& data,
+       churn_totals& totals, cxx_runtime_control* ctrl, int64_t& ncomplete)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    constexpr bool is_inst    = std::is_same<_Tp, mode::inst>::value;
+    int64_t        inst_count = (is_inst) ? (cfg.nthreads * cfg.nregions) : 0;
+    uint64_t       ans        = 0;
+    ncomplete                 = 0;
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && is_inst)
+            ctrl->begin(i);
+        auto t_beg = wtime();
+        for(int64_t j = 0; j < cfg.nthreads; ++j)
+        {
+            churn_times times;
+            times.spawn = wtime();
+            std::thread(churn_thread<_Tp>, std::cref(cfg), std::ref(times)).join();
+            times.joined = wtime();
+            totals += times;
+            ans += times.answer;
+        }
+        auto t_diff = wtime() - t_beg;
+        ++ncomplete;
+        data += entry_t(i, inst_count, t_diff);
+        // only the instrumented entries are streamed
+        if(ctrl && is_inst)
+            ctrl->notify(cxx_trial_record(i, inst_count, t_diff, inst_count / t_diff));
+    }
+    return ans;
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_thread_churn(int64_t nthreads, int64_t nregions, int64_t work, int64_t nitr,
+                         cxx_runtime_control* ctrl, cxx_runtime_data* reference)
+{
+    if(nthreads < 1 || nregions < 1)
+        throw std::runtime_error("thread churn requires nthreads >= 1 and nregions >= 1");
+
+    churn_config     cfg = { nthreads, nregions, work };
+    churn_totals     none_totals;
+    churn_totals     inst_totals;
+    cxx_runtime_data data(nitr);
+    cxx_runtime_data none_data(nitr);
+
+    std::cout << "\nRunning " << nitr << " iterations of thread churn(threads = "
+              << nthreads << ", regions = " << nregions << ", work = " << work << ")..."
+              << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline (warm-up) and instruction mode
+    //----------------------------------------------------------------------------------//
+    int64_t ncomplete = 0;
+    auto    ans_none  = launch<mode::none>(nitr, cfg, none_data, none_totals, ctrl,
+                                       ncomplete);
+
+    auto rss_beg  = current_rss();
+    auto ans_inst = launch<mode::inst>(nitr, cfg, data, inst_totals, ctrl, ncomplete);
+    auto rss_end  = current_rss();
+
+    if(reference)
+        *reference = none_data;
+
+    if(ncomplete < nitr)
+    {
+        // answers are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
+    }
+
+    // we need to use these values so they don't get optimized away
+    if(ans_none != ans_inst)
+    {
+        std::stringstream ss;
+        ss << "Answer w/o instrumentation != answer w/ instrumentation : " << ans_none
+           << " vs. " << ans_inst;
+        throw std::runtime_error(ss.str());
+    }
+
+    auto&   _none     = none_data.timing;
+    double  t_none    = std::accumulate(_none.begin(), _none.end(), 0.0);
+    double  t_inst    = std::accumulate(data.timing.begin(), data.timing.end(), 0.0);
+    int64_t lifetimes = nthreads * nitr;
+    double  _per      = (nitr > 0) ? 1.0 / lifetimes : 0.0;
+
+    // steady-state cost of a region, from the regions after the first one
+    double per_call = 0.0;
+    if(nregions > 1)
+        per_call = (inst_totals.rest - none_totals.rest) * _per / (nregions - 1);
+
+    // set-up: creation of the thread and the first region (less a steady-state region)
+    // tear-down: end of the last region until the thread was joined
+    double create   = (inst_totals.create - none_totals.create) * _per;
+    double first    = (inst_totals.first - none_totals.first) * _per;
+    double teardown = (inst_totals.teardown - none_totals.teardown) * _per;
+
+    data.metrics["nthreads"]            = nthreads;
+    data.metrics["nregions"]            = nregions;
+    data.metrics["work"]                = work;
+    data.metrics["lifetimes"]           = lifetimes;
+    data.metrics["base_timing"]         = (nitr > 0) ? t_none / nitr : 0.0;
+    data.metrics["overhead_per_thread"] = (t_inst - t_none) * _per;
+    data.metrics["overhead_per_call"]   = per_call;
+    data.metrics["create_per_thread"]   = create;
+    data.metrics["setup_per_thread"]    = create + first - per_call;
+    data.metrics["teardown_per_thread"] = teardown;
+    data.metrics["rss_before"]          = rss_beg;
+    data.metrics["rss_after"]           = rss_end;
+    data.metrics["rss_delta"]           = rss_end - rss_beg;
+    data.metrics["rss_per_thread"]      = (rss_end - rss_beg) * _per;
+    data.metrics["peak_rss"]            = peak_rss();
+    return data;
+}
+
+//======================================================================================//
@@ -0,0 +1,597 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//======================================================================================//
+//
+//  binary trace layout (native byte order, see instrument_benchmark/trace.py):
+//
+//      trace_header
+//      trace_event[nevents]                (at sizeof(trace_header))
+//      nlabels null-terminated labels      (at labels_offset)
+//
+//  CSV traces have one "thread,label,event,work_ns" record per line where event is
+//  "start" or "stop" and work_ns is the work (nanoseconds) following the event
+//
+//======================================================================================//
+
+namespace
+{
+const char trace_magic[8] = { 'I', 'N', 'S', 'T', 'T', 'R', 'C', '1' };
+
+struct trace_header
+{
+    char     magic[8];
+    uint64_t version;
+    uint64_t nevents;
+    uint64_t nlabels;
+    uint64_t labels_offset;
+};
+
+struct trace_event
+{
+    uint32_t thread;
+    uint32_t label;
+    uint32_t type;  // 0 = start, 1 = stop
+    uint32_t reserved;
+    uint64_t work;  // nanoseconds of work after the event
+};
+
+static_assert(sizeof(trace_header) == 40, "unexpected trace_header layout");
+static_assert(sizeof(trace_event) == 24, "unexpected trace_event layout");
+
+//--------------------------------------------------------------------------------------//
+/// file descriptor closed when it goes out of scope
+struct scoped_fd
+{
+    int fd = -1;
+
+    explicit scoped_fd(int _fd)
+    : fd(_fd)
+    {
+    }
+
+    ~scoped_fd()
+    {
+        if(fd >= 0)
+            close(fd);
+    }
+
+    scoped_fd(const scoped_fd&) = delete;
+    scoped_fd& operator=(const scoped_fd&) = delete;
+};
+
+//--------------------------------------------------------------------------------------//
+/// read-only mapping of a file, unmapped when it goes out of scope
+struct scoped_mapping
+{
+    void*  data   = nullptr;
+    size_t length = 0;
+
+    scoped_mapping() = default;
+
+    ~scoped_mapping()
+    {
+        if(data)
+            munmap(data, length);
+    }
+
+    scoped_mapping(const scoped_mapping&) = delete;
+    scoped_mapping& operator=(const scoped_mapping&) = delete;
+};
+
+//--------------------------------------------------------------------------------------//
+/// removes the leading and trailing white-space (including '\r' of CRLF files)
+inline std::string
+trim(const std::string& _str)
+{
+    const char* _space = " \t\r\n";
+    auto        _beg   = _str.find_first_not_of(_space);
+    if(_beg == std::string::npos)
+        return std::string{};
+    return _str.substr(_beg, _str.find_last_not_of(_space) - _beg + 1);
+}
+
+//--------------------------------------------------------------------------------------//
+/// a loaded trace: binary traces are memory-mapped, CSV traces are parsed into memory.
+/// The members release the file and the mapping if the constructor throws
+struct trace_file
+{
+    const trace_event*       events  = nullptr;
+    uint64_t                 nevents = 0;
+    std::vector<std::string> labels;
+
+    explicit trace_file(const std::string& path)
+    {
+        scoped_fd _file(open(path.c_str(), O_RDONLY));
+        if(_file.fd < 0)
+            throw std::runtime_error("unable to open trace '" + path +
+                                     "': " + strerror(errno));
+
+        struct stat _stat;
+        if(fstat(_file.fd, &_stat) != 0)
+            throw std::runtime_error("unable to stat trace '" + path + "'");
+
+        char _magic[8] = {};
+        if(read(_file.fd, _magic, sizeof(_magic)) == sizeof(_magic) &&
+           memcmp(_magic, trace_magic, sizeof(_magic)) == 0)
+            map_binary(_file.fd, _stat.st_size, path);
+        else
+            parse_csv(path);
+    }
+
+    trace_file(const trace_file&) = delete;
+    trace_file& operator=(const trace_file&) = delete;
+
+private:
+    scoped_mapping           mapping;
+    std::vector<trace_event> parsed;
+
+    void map_binary(int fd, size_t size, const std::string& path)
+    {
+        if(size < sizeof(trace_header))
+            throw std::runtime_error("truncated trace '" + path + "'");
+
+        void* _ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(_ptr == MAP_FAILED)
+            throw std::runtime_error("unable to map trace '" + path +
+                                     "': " + strerror(errno));
+        mapping.data   = _ptr;
+        mapping.length = size;
+
+        // nevents is compared without multiplying so that a corrupt count can not wrap
+        auto _beg    = static_cast<const char*>(_ptr);
+        auto _header = reinterpret_cast<const trace_header*>(_beg);
+        if(_header->version != 1 ||
+           _header->nevents > (size - sizeof(trace_header)) / sizeof(trace_event) ||
+           _header->labels_offset > size)
+            throw std::runtime_error("invalid trace header in '" + path + "'");
+
+        events  = reinterpret_cast<const trace_event*>(_beg + sizeof(trace_header));
+        nevents = _header->nevents;
+
+        const char* _label = _beg + _header->labels_offset;
+        const char* _end   = _beg + size;
+        for(uint64_t i = 0; i < _header->nlabels; ++i)
+        {
+            size_t _len = strnlen(_label, _end - _label);
+            if(_label + _len >= _end)
+                throw std::runtime_error("truncated label table in '" + path + "'");
+            labels.push_back(std::string(_label, _len));
+            _label += _len + 1;
+        }
+    }
+
+    void parse_csv(const std::string& path)
+    {
+        std::ifstream ifs(path);
+        if(!ifs)
+            throw std::runtime_error("unable to read trace '" + path + "'");
+
+        std::map<std::string, uint32_t> _ids;
+        std::string                     _line;
+        int64_t                         _lineno = 0;
+        while(std::getline(ifs, _line))
+        {
+            ++_lineno;
+            // same rules as read_csv in instrument_benchmark/trace.py
+            _line = trim(_line);
+            if(_line.empty() || _line[0] == '#')
+                continue;
+
+            std::stringstream        ss(_line);
+            std::vector<std::string> _fields;
+            std::string              _field;
+            while(std::getline(ss, _field, ','))
+                _fields.push_back(trim(_field));
+            // a trailing comma is an empty field, as with str.split(",")
+            if(_line.back() == ',')
+                _fields.push_back(std::string{});
+
+            // optional header line
+            if(_lineno == 1 && !_fields.empty() && _fields[0] == "thread")
+                continue;
+
+            auto _invalid = [&]() {
+                std::stringstream _msg;
+                _msg << "invalid record at " << path << ":" << _lineno;
+                return std::runtime_error(_msg.str());
+            };
+
+            if(_fields.size() != 4 || (_fields[2] != "start" && _fields[2] != "stop"))
+                throw _invalid();
+
+            uint64_t _thread = 0;
+            uint64_t _work   = 0;
+            try
+            {
+                size_t _tpos = 0;
+                size_t _wpos = 0;
+                _thread      = std::stoull(_fields[0], &_tpos);
+                _work        = std::stoull(_fields[3], &_wpos);
+                if(_tpos != _fields[0].size() || _wpos != _fields[3].size() ||
+                   _thread > std::numeric_limits<uint32_t>::max())
+                    throw _invalid();
+            } catch(std::logic_error&)
+            {
+                // std::invalid_argument or std::out_of_range
+                throw _invalid();
+            }
+
+            auto _id = _ids.find(_fields[1]);
+            if(_id == _ids.end())
+            {
+                _id = _ids.insert({ _fields[1], static_cast<uint32_t>(labels.size()) })
+                          .first;
+                labels.push_back(_fields[1]);
+            }
+
+            trace_event _event;
+            _event.thread   = static_cast<uint32_t>(_thread);
+            _event.label    = _id->second;
+            _event.type     = (_fields[2] == "stop") ? 1 : 0;
+            _event.reserved = 0;
+            _event.work     = _work;
+            parsed.push_back(_event);
+        }
+        events  = parsed.data();
+        nevents = parsed.size();
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+/// events of a single trace thread
+struct trace_thread
+{
+    uint32_t                        id = 0;
+    std::vector<const trace_event*> events;
+    int64_t                         max_depth = 0;
+};
+
+}  // namespace
+
+//======================================================================================//
+// iterations of busy_work per nanosecond
+
+double
+replay_calibrate()
+{
+    uint64_t _iter = 1000;
+    double   _time = 0.0;
+    uint64_t _sum  = 0;
+    // grow until the measurement takes at least 10 milliseconds
+    while(_time < 1.0e-2)
+    {
+        _iter *= 2;
+        auto _beg = wtime();
+        _sum += busy_work(_iter, _iter);
+        _time = wtime() - _beg;
+    }
+    // use the value so the loop is not optimized away
+    return (_sum == 0) ? 0.0 : (static_cast<double>(_iter) / (_time * 1.0e9));
+}
+
+//======================================================================================//
+// replays the region opened by events[idx] and everything nested inside it. Returns
+// the index of the matching stop event. Each region is a scope so the macros may
+// declare local variables
+
+template <typename _Tp, typename std::enable_if<
+                            std::is_same<_Tp, mode::inst>::value, int>::type = 0>
+size_t
+replay_region(const trace_thread&, const std::vector<uint64_t>&, const char**, size_t,
+              uint64_t&);
+
+template <typename _Tp, typename std::enable_if<
+                            std::is_same<_Tp, mode::none>::value, int>::type = 0>
+size_t
+replay_region(const trace_thread&, const std::vector<uint64_t>&, const char**, size_t,
+              uint64_t&);
+
+//--------------------------------------------------------------------------------------//
+
+template <typename _Tp>
+size_t
+replay_body(const trace_thread& thr, const std::vector<uint64_t>& work,
+            const char** labels, size_t idx, uint64_t& ans)
+{
+    // work following the start event
+    ans += busy_work(idx, work[idx]);
+    ++idx;
+    while(idx < thr.events.size() && thr.events[idx]->type == 0)
+    {
+        idx = replay_region<_Tp>(thr, work, labels, idx, ans);
+        // work following the nested stop event
+        ans += busy_work(idx, work[idx]);
+        ++idx;
+    }
+    return idx;
+}
+
+//--------------------------------------------------------------------------------------//
+
+template <typename _Tp, typename std::enable_if<
+                            std::is_same<_Tp, mode::inst>::value, int>::type>
+size_t
+replay_region(const trace_thread& thr, const std::vector<uint64_t>& work,
+              const char** labels, size_t idx, uint64_t& ans)
+{
+    const char* label = labels[thr.events[idx]->label];
+    INSTRUMENT_CREATE(label);
+    INSTRUMENT_START(label);
+    idx = replay_body<_Tp>(thr, work, labels, idx, ans);
+    INSTRUMENT_STOP(label);
+    // the label is unused when the macros are empty
+    (void) label;
+    return idx;
+}
+
+//--------------------------------------------------------------------------------------//
+
+template <typename _Tp, typename std::enable_if<
+                            std::is_same<_Tp, mode::none>::value, int>::type>
+size_t
+replay_region(const trace_thread& thr, const std::vector<uint64_t>& work,
+              const char** labels, size_t idx, uint64_t& ans)
+{
+    return replay_body<_Tp>(thr, work, labels, idx, ans);
+}
+
+//--------------------------------------------------------------------------------------//
+// replays all the top-level regions of a thread (work preceding the first region is
+// not part of any region and is replayed as well)
+
+template <typename _Tp>
+uint64_t
+replay_thread(const trace_thread& thr, const std::vector<uint64_t>& work,
+              const char** labels)
+{
+    uint64_t ans = 0;
+    size_t   idx = 0;
+    while(idx < thr.events.size())
+    {
+        idx = replay_region<_Tp>(thr, work, labels, idx, ans);
+        ans += busy_work(idx, work[idx]);
+        ++idx;
+    }
+    return ans;
+}
+
+//======================================================================================//
+
+template <typename _Tp>
+uint64_t
+replay(const std::vector<trace_thread>& threads,
+       const std::vector<std::vector<uint64_t>>& work, const char** labels,
+       double& elapsed)
+{
+    std::vector<uint64_t>    answers(threads.size(), 0);
+    std::vector<std::thread> workers;
+    std::atomic<size_t>      ready(0);
+    std::atomic<bool>        go(false);
+
+    auto _func = [&](size_t i) {
+        ++ready;
+        // yield so that oversubscribed threads don't starve the thread releasing them
+        while(!go.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        answers[i] = replay_thread<_Tp>(threads[i], work[i], labels);
+    };
+
+    // the first trace thread is replayed by the calling thread
+    for(size_t i = 1; i < threads.size(); ++i)
+        workers.push_back(std::thread(_func, i));
+    while(ready.load() + 1 < threads.size())
+        std::this_thread::yield();
+
+    auto t_beg = wtime();
+    go.store(true, std::memory_order_release);
+    answers[0] = replay_thread<_Tp>(threads[0], work[0], labels);
+    for(auto& itr : workers)
+        itr.join();
+    elapsed = wtime() - t_beg;
+
+    return std::accumulate(answers.begin(), answers.end(), uint64_t(0));
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_trace_replay(const std::string& path, int64_t nitr,
+                         cxx_runtime_control* ctrl, cxx_runtime_data* reference)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    trace_file trace(path);
+
+    //----------------------------------------------------------------------------------//
+    //      split the events per thread and validate the nesting
+    //----------------------------------------------------------------------------------//
+    std::map<uint32_t, size_t> _index;
+    std::vector<trace_thread>  threads;
+    int64_t                    nregions = 0;
+    uint64_t                   total_ns = 0;
+    for(uint64_t i = 0; i < trace.nevents; ++i)
+    {
+        const trace_event* _event = trace.events + i;
+        if(_event->label >= trace.labels.size())
+            throw std::runtime_error("trace event references an unknown label");
+        if(_index.find(_event->thread) == _index.end())
+        {
+            _index[_event->thread] = threads.size();
+            threads.push_back(trace_thread{});
+            threads.back().id = _event->thread;
+        }
+        threads[_index[_event->thread]].events.push_back(_event);
+        nregions += (_event->type == 0) ? 1 : 0;
+        total_ns += _event->work;
+    }
+
+    for(auto& thr : threads)
+    {
+        std::vector<uint32_t> _stack;
+        for(const auto& itr : thr.events)
+        {
+            if(itr->type == 0)
+            {
+                _stack.push_back(itr->label);
+                thr.max_depth = std::max<int64_t>(thr.max_depth, _stack.size());
+            }
+            else if(_stack.empty() || _stack.back() != itr->label)
+            {
+                std::stringstream ss;
+                ss << "unbalanced stop of '" << trace.labels[itr->label]
+                   << "' on thread " << thr.id << " in trace '" << path << "'";
+                throw std::runtime_error(ss.str());
+            }
+            else
+                _stack.pop_back();
+        }
+        if(!_stack.empty())
+        {
+            std::stringstream ss;
+            ss << "unterminated region '" << trace.labels[_stack.back()] << "' on thread "
+               << thr.id << " in trace '" << path << "'";
+            throw std::runtime_error(ss.str());
+        }
+    }
+
+    if(threads.empty())
+        throw std::runtime_error("trace '" + path + "' has no events");
+
+    //----------------------------------------------------------------------------------//
+    //      calibrate the busy-work and convert durations to iterations
+    //----------------------------------------------------------------------------------//
+    double                             rate = replay_calibrate();
+    std::vector<std::vector<uint64_t>> work(threads.size());
+    for(size_t i = 0; i < threads.size(); ++i)
+        for(const auto& itr : threads[i].events)
+            work[i].push_back(static_cast<uint64_t>(itr->work * rate));
+
+    std::vector<const char*> labels;
+    for(const auto& itr : trace.labels)
+        labels.push_back(itr.c_str());
+
+    int64_t max_depth = 0;
+    for(const auto& itr : threads)
+        max_depth = std::max(max_depth, itr.max_depth);
+
+    std::cout << "\nReplaying " << nitr << " iterations of trace '" << path << "' ("
+              << trace.nevents << " events, " << threads.size() << " threads, "
+              << labels.size() << " labels)..." << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline (warm-up) and instruction mode
+    //----------------------------------------------------------------------------------//
+    cxx_runtime_data data(nitr);
+    cxx_runtime_data none_data(nitr);
+
+    uint64_t ans_none = 0;
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        double t_diff = 0.0;
+        ans_none      = replay<mode::none>(threads, work, labels.data(), t_diff);
+        none_data += entry_t(i, 0, t_diff);
+    }
+
+    if(reference)
+        *reference = none_data;
+
+    int64_t ncomplete = 0;
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl)
+            ctrl->begin(i);
+        double t_diff   = 0.0;
+        auto   ans_inst = replay<mode::inst>(threads, work, labels.data(), t_diff);
+        if(ans_inst != ans_none)
+        {
+            std::stringstream ss;
+            ss << "Answer w/o instrumentation != answer w/ instrumentation : "
+               << ans_none << " vs. " << ans_inst;
+            throw std::runtime_error(ss.str());
+        }
+        data += entry_t(i, nregions, t_diff);
+        ++ncomplete;
+        if(ctrl)
+            ctrl->notify(cxx_trial_record(i, nregions, t_diff, nregions / t_diff));
+    }
+
+    if(ncomplete < nitr)
+    {
+        data.resize(ncomplete);
+        return data;
+    }
+
+    auto&  _none  = none_data.timing;
+    double t_none = std::accumulate(_none.begin(), _none.end(), 0.0);
+    double t_inst = std::accumulate(data.timing.begin(), data.timing.end(), 0.0);
+
+    data.metrics["events"]      = trace.nevents;
+    data.metrics["regions"]     = nregions;
+    data.metrics["threads"]     = threads.size();
+    data.metrics["labels"]      = labels.size();
+    data.metrics["max_depth"]   = max_depth;
+    data.metrics["trace_work"]  = 1.0e-9 * total_ns;
+    data.metrics["work_rate"]   = rate;
+    data.metrics["base_timing"] = (nitr > 0) ? t_none / nitr : 0.0;
+    data.metrics["slowdown"]    = (t_none > 0.0) ? t_inst / t_none : 0.0;
+    return data;
+}
+
+//======================================================================================//
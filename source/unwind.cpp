@@ -0,0 +1,421 @@
+// MIT License
+//
+// Copyright (c) 2019 NERSC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "@SUBMODULE_HEADER_FILE@"
+
+// assume this is bare minimum...
+#if !defined(INSTRUMENT_CREATE) && !defined(INSTRUMENT_START)
+#    error "Submodule header did not define INSTRUMENT_CREATE or INSTRUMENT_START"
+#endif
+
+// provides instrumentation definitions if not
+#include "fallback_inst.h"
+// provides structures for returning data to python
+#include "instrumentation.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+namespace
+{
+namespace mode
+{
+// clang-format off
+struct check {};  // inst + queries the region depth of the tool at every catch
+// clang-format on
+}  // namespace mode
+
+struct unwind_config
+{
+    int64_t cutoff;
+    int64_t catch_n;  // regions with n >= catch_n catch the exceptions of their leaves
+    double  rate;
+};
+
+// thrown by a leaf, carries the value the catching region returns
+struct unwind_error
+{
+    int64_t value;
+};
+
+struct unwind_state
+{
+    uint64_t leaf    = 0;
+    bool     failed  = false;  // error propagated by return value
+    int64_t  value   = 0;
+    int64_t  nthrow  = 0;
+    int64_t  ncaught = 0;
+    int64_t  regions = 0;
+    // region depth of the tool when the run started, the checks and the regions left
+    // open by the run
+    int64_t base    = INSTRUMENT_DEPTH_UNKNOWN;
+    int64_t checked = 0;
+    int64_t errors  = 0;
+    int64_t leaked  = 0;
+};
+
+template <typename _Tp>
+using is_inst = std::integral_constant<bool, std::is_same<_Tp, mode::inst>::value ||
+                                                 std::is_same<_Tp, mode::check>::value>;
+
+}  // namespace
+
+//======================================================================================//
+
+int64_t
+unwind_fib(int64_t n)
+{
+    return (n < 2) ? n : (unwind_fib(n - 1) + unwind_fib(n - 2));
+}
+
+//======================================================================================//
+// the same leaves fail in every mode: the decision only depends on the leaf index
+
+bool
+unwind_fail(unwind_state& st, double rate)
+{
+    uint64_t z = (st.leaf++) + 0x9e3779b97f4a7c15ULL;
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z          = z ^ (z >> 31);
+    return (z >> 11) * (1.0 / 9007199254740992.0) < rate;
+}
+
+//======================================================================================//
+// compare the region depth of the tool with the regions the kernel has open
+
+template <typename _Tp, enable_if<!std::is_same<_Tp, mode::check>::value> = 0>
+void
+unwind_check(int64_t, unwind_state&)
+{
+}
+
+template <typename _Tp, enable_if<std::is_same<_Tp, mode::check>::value> = 0>
+void
+unwind_check(int64_t level, unwind_state& st)
+{
+    int64_t depth = INSTRUMENT_QUERY_DEPTH();
+    if(st.base == INSTRUMENT_DEPTH_UNKNOWN || depth == INSTRUMENT_DEPTH_UNKNOWN)
+        return;
+    st.checked += 1;
+    if(depth != st.base + level)
+        st.errors += 1;
+}
+
+//======================================================================================//
+
+template <typename _Tp>
+void
+unwind_count(unwind_state& st)
+{
+    if(std::is_same<_Tp, mode::check>::value)
+        st.regions += 1;
+}
+
+//======================================================================================//
+
+template <typename _Tp, bool _Throw>
+int64_t
+unwind_node(int64_t n, int64_t level, const unwind_config& cfg, unwind_state& st);
+
+//======================================================================================//
+
+template <typename _Tp, bool _Throw>
+int64_t
+unwind_children(int64_t n, int64_t level, const unwind_config& cfg, unwind_state& st)
+{
+    int64_t a = unwind_node<_Tp, _Throw>(n - 1, level, cfg, st);
+    if(!_Throw && st.failed)
+        return 0;
+    int64_t b = unwind_node<_Tp, _Throw>(n - 2, level, cfg, st);
+    if(!_Throw && st.failed)
+        return 0;
+    return a + b;
+}
+
+//======================================================================================//
+// level is the number of regions open in the kernel, including this one
+
+template <typename _Tp, bool _Throw, enable_if<_Throw> = 0>
+int64_t
+unwind_body(int64_t n, int64_t level, const unwind_config& cfg, unwind_state& st)
+{
+    if(n < cfg.catch_n)
+        return unwind_children<_Tp, _Throw>(n, level, cfg, st);
+    try
+    {
+        return unwind_children<_Tp, _Throw>(n, level, cfg, st);
+    } catch(const unwind_error& e)
+    {
+        st.ncaught += 1;
+        unwind_check<_Tp>(level, st);
+        return e.value;
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+// the error is returned through every level instead of unwinding
+
+template <typename _Tp, bool _Throw, enable_if<!_Throw> = 0>
+int64_t
+unwind_body(int64_t n, int64_t level, const unwind_config& cfg, unwind_state& st)
+{
+    int64_t ret = unwind_children<_Tp, _Throw>(n, level, cfg, st);
+    if(n >= cfg.catch_n && st.failed)
+    {
+        st.failed = false;
+        st.ncaught += 1;
+        unwind_check<_Tp>(level, st);
+        return st.value;
+    }
+    return ret;
+}
+
+//======================================================================================//
+
+template <typename _Tp, bool _Throw, enable_if<!is_inst<_Tp>::value> = 0>
+int64_t
+unwind_region(int64_t n, int64_t level, const unwind_config& cfg, unwind_state& st)
+{
+    return unwind_body<_Tp, _Throw>(n, level, cfg, st);
+}
+
+//--------------------------------------------------------------------------------------//
+// INSTRUMENT_STOP is skipped when an exception crosses the region
+
+template <typename _Tp, bool _Throw, enable_if<is_inst<_Tp>::value> = 0>
+int64_t
+unwind_region(int64_t n, int64_t level, const unwind_config& cfg, unwind_state& st)
+{
+    unwind_count<_Tp>(st);
+    INSTRUMENT_CREATE(n);
+    INSTRUMENT_START(n);
+    int64_t ret = unwind_body<_Tp, _Throw>(n, level + 1, cfg, st);
+    INSTRUMENT_STOP(n);
+    return ret;
+}
+
+//======================================================================================//
+
+template <typename _Tp, bool _Throw>
+int64_t
+unwind_node(int64_t n, int64_t level, const unwind_config& cfg, unwind_state& st)
+{
+    if(n > cfg.cutoff)
+        return unwind_region<_Tp, _Throw>(n, level, cfg, st);
+
+    int64_t ret = unwind_fib(n);
+    if(unwind_fail(st, cfg.rate))
+    {
+        st.nthrow += 1;
+        if(_Throw)
+            throw unwind_error{ ret };
+        st.failed = true;
+        st.value  = ret;
+        return 0;
+    }
+    return ret;
+}
+
+//======================================================================================//
+// errors which are not caught by a region are caught here
+
+template <typename _Tp, bool _Throw>
+int64_t
+unwind_run(int64_t nfib, const unwind_config& cfg, unwind_state& st)
+{
+    st.leaf   = 0;
+    st.failed = false;
+    try
+    {
+        int64_t ret = unwind_node<_Tp, _Throw>(nfib, 0, cfg, st);
+        if(!st.failed)
+            return ret;
+        st.failed = false;
+    } catch(const unwind_error& e)
+    {
+        st.value = e.value;
+    }
+    st.ncaught += 1;
+    unwind_check<_Tp>(0, st);
+    return st.value;
+}
+
+//======================================================================================//
+
+template <typename _Tp, bool _Throw>
+int64_t
+launch(int64_t nitr, int64_t nfib, int64_t nregions, const unwind_config& cfg,
+       cxx_runtime_data& data, unwind_state& st, cxx_runtime_control* ctrl,
+       int64_t& ncomplete)
+{
+    using entry_t = std::tuple<int64_t, int64_t, double>;
+
+    // only the instrumented entries with exceptions are streamed
+    constexpr bool is_streamed = is_inst<_Tp>::value && _Throw;
+    int64_t        inst_count  = (is_inst<_Tp>::value) ? nregions : 0;
+    int64_t        ans         = 0;
+    ncomplete                  = 0;
+    for(int64_t i = 0; i < nitr; ++i)
+    {
+        if(ctrl && ctrl->interrupted())
+            break;
+        if(ctrl && is_streamed)
+            ctrl->begin(i);
+        auto t_beg  = wtime();
+        ans += unwind_run<_Tp, _Throw>(nfib, cfg, st);
+        auto t_diff = wtime() - t_beg;
+        ++ncomplete;
+        data += entry_t(i, inst_count, t_diff);
+        if(ctrl && is_streamed)
+            ctrl->notify(cxx_trial_record(i, inst_count, t_diff, inst_count / t_diff));
+    }
+    return ans;
+}
+
+//======================================================================================//
+
+cxx_runtime_data
+cxx_execute_unwind(int64_t nfib, int64_t cutoff, double rate, int64_t levels,
+                   int64_t nitr, cxx_runtime_control* ctrl, cxx_runtime_data* reference)
+{
+    if(levels < 0)
+        throw std::runtime_error("unwind requires levels >= 0");
+
+    unwind_config cfg = { cutoff, cutoff + levels + 1, rate };
+
+    std::cout << "\nRunning " << nitr << " iterations of unwinding fib(n = " << nfib
+              << ", cutoff = " << cutoff << ", rate = " << rate << ", levels = " << levels
+              << ")..." << std::endl;
+
+    //----------------------------------------------------------------------------------//
+    //      count the regions and check the region depth of the tool in a new thread, so
+    //      the depth does not depend on previous tests
+    //----------------------------------------------------------------------------------//
+    unwind_state check;
+    int64_t      ans_check = 0;
+    std::thread([&]() {
+        check.base = INSTRUMENT_QUERY_DEPTH();
+        ans_check  = unwind_run<mode::check, true>(nfib, cfg, check);
+        int64_t depth = INSTRUMENT_QUERY_DEPTH();
+        if(check.base != INSTRUMENT_DEPTH_UNKNOWN && depth != INSTRUMENT_DEPTH_UNKNOWN)
+        {
+            check.checked += 1;
+            check.leaked = depth - check.base;
+            if(check.leaked != 0)
+                check.errors += 1;
+        }
+    }).join();
+
+    //----------------------------------------------------------------------------------//
+    //      run baseline (warm-up) and instruction modes, errors are either returned
+    //      through every level or thrown
+    //----------------------------------------------------------------------------------//
+    cxx_runtime_data none_ret(nitr);
+    cxx_runtime_data none_throw(nitr);
+    cxx_runtime_data inst_ret(nitr);
+    cxx_runtime_data data(nitr);
+    unwind_state     st_none_ret;
+    unwind_state     st_none_throw;
+    unwind_state     st_inst_ret;
+    unwind_state     st_inst_throw;
+
+    int64_t nregions  = check.regions;
+    int64_t ncomplete = 0;
+    int64_t ans[4];
+    ans[0] = launch<mode::none, false>(nitr, nfib, nregions, cfg, none_ret, st_none_ret,
+                                       ctrl, ncomplete);
+    ans[1] = launch<mode::none, true>(nitr, nfib, nregions, cfg, none_throw,
+                                      st_none_throw, ctrl, ncomplete);
+    ans[2] = launch<mode::inst, false>(nitr, nfib, nregions, cfg, inst_ret, st_inst_ret,
+                                       ctrl, ncomplete);
+    ans[3] = launch<mode::inst, true>(nitr, nfib, nregions, cfg, data, st_inst_throw,
+                                      ctrl, ncomplete);
+
+    if(reference)
+        *reference = none_throw;
+
+    if(ncomplete < nitr)
+    {
+        // answers are not comparable after stopping early
+        data.resize(ncomplete);
+        return data;
+    }
+
+    // we need to use these values so they don't get optimized away
+    for(int64_t i = 1; i < 4; ++i)
+    {
+        if(ans[i] != ans[0])
+        {
+            std::stringstream ss;
+            ss << "Answer w/ errors returned != answer w/ errors thrown : " << ans[0]
+               << " vs. " << ans[i];
+            throw std::runtime_error(ss.str());
+        }
+    }
+
+    if(ans_check * nitr != ans[0])
+    {
+        std::stringstream ss;
+        ss << "Answer during check != answer during run : " << ans_check * nitr
+           << " vs. " << ans[0];
+        throw std::runtime_error(ss.str());
+    }
+
+    auto _sum = [](const cxx_runtime_data& _data) {
+        return std::accumulate(_data.timing.begin(), _data.timing.end(), 0.0);
+    };
+
+    double t_none_ret   = _sum(none_ret);
+    double t_none_throw = _sum(none_throw);
+    double t_inst_ret   = _sum(inst_ret);
+    double t_inst_throw = _sum(data);
+    double ncalls       = static_cast<double>(nregions * nitr);
+    double nthrow       = static_cast<double>(check.nthrow * nitr);
+    double unwind_none  = (nthrow > 0) ? (t_none_throw - t_none_ret) / nthrow : 0.0;
+    double unwind_inst  = (nthrow > 0) ? (t_inst_throw - t_inst_ret) / nthrow : 0.0;
+
+    data.metrics["rate"]              = rate;
+    data.metrics["levels"]            = levels;
+    data.metrics["regions"]           = nregions;
+    data.metrics["throws"]            = check.nthrow;
+    data.metrics["caught"]            = check.ncaught;
+    data.metrics["base_timing"]       = (nitr > 0) ? t_none_throw / nitr : 0.0;
+    data.metrics["overhead_per_call"] = (ncalls > 0) ? (t_inst_ret - t_none_ret) / ncalls
+                                                     : 0.0;
+    data.metrics["unwind_per_throw"]      = unwind_none;
+    data.metrics["unwind_per_throw_inst"] = unwind_inst;
+    data.metrics["unwind_overhead"]       = unwind_inst - unwind_none;
+    data.metrics["depth_checked"]         = check.checked;
+    data.metrics["depth_errors"]          = check.errors;
+    data.metrics["leaked_regions"]        = check.leaked;
+    return data;
+}
+
+//======================================================================================//